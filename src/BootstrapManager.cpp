@@ -57,6 +57,27 @@ void BootstrapManager::bootstrapSetup(void (*manageDisconnections)(), void (*man
   };
   esp_task_wdt_init(&twdt_config); //enable panic so ESP32 restarts
   esp_task_wdt_add(NULL); //add current thread to WDT watch
+  TaskScheduler::every(DELAY_1000, feedWatchdog);
+#endif
+#if (LOOP_PROFILER_ENABLED)
+  LoopProfiler::begin();
+#endif
+  logger.begin();
+  HeapMonitor::begin();
+#if (PING_INTERVAL > 0)
+  if (isConfigFileOk) {
+    PingService::begin();
+  }
+#endif
+#if (HEALTH_INTERVAL > 0)
+  if (isConfigFileOk) {
+    HealthMonitor::begin();
+  }
+#endif
+#if (ROAMING_CHECK_INTERVAL > 0)
+  if (isConfigFileOk) {
+    RoamingManager::begin();
+  }
 #endif
 #if CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32S3
   Serial.setTxTimeoutMs(0);
@@ -72,6 +93,7 @@ void eth_event(WiFiEvent_t event) {
     case ARDUINO_EVENT_ETH_CONNECTED:
       Serial.println("ETH Connected");
       ethConnected = true;
+      LinkManager::linkChanged();
       break;
     case ARDUINO_EVENT_ETH_GOT_IP:
       microcontrollerIP = ETH.localIP().toString();
@@ -86,18 +108,25 @@ void eth_event(WiFiEvent_t event) {
       Serial.print(", ");
       Serial.print(ETH.linkSpeed());
       Serial.println("Mbps");
+      LinkManager::linkChanged();
       break;
     case ARDUINO_EVENT_ETH_DISCONNECTED:
       Serial.println("ETH Disconnected");
       ethConnected = false;
       microcontrollerIP = F("0.0.0.0");
       currentWiFiIp = IPAddress(0, 0, 0, 0);
+      LinkManager::linkChanged();
       break;
     case ARDUINO_EVENT_ETH_STOP:
       Serial.println("ETH Stopped");
       ethConnected = false;
       microcontrollerIP = F("0.0.0.0");
       currentWiFiIp = IPAddress(0, 0, 0, 0);
+      LinkManager::linkChanged();
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      LinkManager::linkChanged();
       break;
     default:
       break;
@@ -118,9 +147,10 @@ void BootstrapManager::bootstrapSetup(void (*manageDisconnections)(), void (*man
   } else if (ethd > 0) {
 #if defined(ARDUINO_ARCH_ESP32)
     isConfigFileOk = true;
-    ETH.setHostname(Helpers::string2char(deviceName));
+    ETH.setHostname(deviceName.c_str());
     WiFi.onEvent(eth_event);
-    EthManager::connectToEthernet(ethd, mosi, miso, sclk, cs);
+    EthManager::connectToEthernet(ethd, mosi, miso, sclk, cs, interrupt, rst);
+    LinkManager::begin();
     wifiManager.setupWiFi(manageDisconnections, manageHardwareButton);
     initMqttOta(callback);
 #endif
@@ -135,6 +165,27 @@ void BootstrapManager::bootstrapSetup(void (*manageDisconnections)(), void (*man
   };
   esp_task_wdt_init(&twdt_config); //enable panic so ESP32 restarts
   esp_task_wdt_add(NULL); //add current thread to WDT watch
+  TaskScheduler::every(DELAY_1000, feedWatchdog);
+#endif
+#if (LOOP_PROFILER_ENABLED)
+  LoopProfiler::begin();
+#endif
+  logger.begin();
+  HeapMonitor::begin();
+#if (PING_INTERVAL > 0)
+  if (isConfigFileOk) {
+    PingService::begin();
+  }
+#endif
+#if (HEALTH_INTERVAL > 0)
+  if (isConfigFileOk) {
+    HealthMonitor::begin();
+  }
+#endif
+#if (ROAMING_CHECK_INTERVAL > 0)
+  if (isConfigFileOk) {
+    RoamingManager::begin();
+  }
 #endif
 #if CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32C5 || CONFIG_IDF_TARGET_ESP32S2 || CONFIG_IDF_TARGET_ESP32S3
   Serial.setTxTimeoutMs(0);
@@ -155,12 +206,38 @@ void BootstrapManager::initMqttOta(void (*callback)(char *, byte *, unsigned int
 /********************************** BOOTSTRAP FUNCTIONS FOR LOOP() *****************************************/
 bool rcpResponseSent = false;
 void BootstrapManager::bootstrapLoop(void (*manageDisconnections)(), void (*manageQueueSubscription)(), void (*manageHardwareButton)()) {
-#if defined(ARDUINO_ARCH_ESP32)
-  if (millis() - lastMillisForWdt >= 3000) {
-    lastMillisForWdt = millis();
-    esp_task_wdt_reset();
-  }
+  PROFILER_LOOP_BEGIN();
+  PROFILER_BEGIN();
+  TaskScheduler::run();
+  PROFILER_STAGE(Stage_Scheduler);
+#if (NETWORK_TASK_ACTIVE)
+  if (networkTaskHandle == nullptr && !networkTaskFailed && isConfigFileOk) {
+    startNetworkTask(manageDisconnections, manageQueueSubscription, manageHardwareButton);
+  }
+  if (networkTaskHandle == nullptr) {
+    networkLoop(manageDisconnections, manageQueueSubscription, manageHardwareButton);
+  }
+#else
+  networkLoop(manageDisconnections, manageQueueSubscription, manageHardwareButton);
 #endif
+#if (INBOUND_QUEUE_ACTIVE)
+  // messages received by the MQTT client are delivered here, outside of the PubSubClient callback
+  PROFILER_RESTART();
+  QueueManager::processInbound(INBOUND_QUEUE_BATCH);
+  PROFILER_STAGE(Stage_Callback);
+#endif
+  logger.drain();
+#if (NETWORK_TASK_ACTIVE)
+  // the reconnection messages of the network task are drawn here, the display is never touched by two cores
+  QueueManager::processApplicationActions();
+#endif
+  DisplayManager::update();
+  PROFILER_LOOP_END();
+}
+
+// WiFi, Improv, OTA and MQTT, called by bootstrapLoop() or by the network task
+void BootstrapManager::networkLoop(void (*manageDisconnections)(), void (*manageQueueSubscription)(), void (*manageHardwareButton)()) {
+  PROFILER_BEGIN();
 #if (IMPROV_ENABLED > 0)
   if (!rcpResponseSent && WifiManager::isConnected()) {
     rcpResponseSent = true;
@@ -169,12 +246,76 @@ void BootstrapManager::bootstrapLoop(void (*manageDisconnections)(), void (*mana
   if (!temporaryDisableImprove) {
     wifiManager.handleImprovPacket();
   }
+  PROFILER_STAGE(Stage_Improv);
 #endif
   wifiManager.reconnectToWiFi(manageDisconnections, manageHardwareButton);
+#if (NETWORK_TASK_ACTIVE)
+  QueueManager::processNetworkActions();
+#endif
+  PROFILER_STAGE(Stage_WiFi);
+#if defined(ARDUINO_ARCH_ESP32)
+  if (ethd > 0) {
+    LinkManager::loop();
+  }
+#endif
   ArduinoOTA.handle();
+  PROFILER_STAGE(Stage_OTA);
   if (mqttIP.length() > 0) {
     queueManager.queueLoop(manageDisconnections, manageQueueSubscription, manageHardwareButton);
+#if (NETWORK_TASK_ACTIVE)
+    QueueManager::processOutbound();
+#endif
   }
+  PROFILER_STAGE(Stage_MQTT);
+}
+
+#if (NETWORK_TASK_ACTIVE)
+/********************************** NETWORK TASK PINNED TO CORE 0 **********************************/
+void BootstrapManager::startNetworkTask(void (*manageDisconnections)(), void (*manageQueueSubscription)(), void (*manageHardwareButton)()) {
+  manageDisconnectionsFunction = manageDisconnections;
+  manageQueueSubscriptionFunction = manageQueueSubscription;
+  manageHardwareButtonFunction = manageHardwareButton;
+  if (xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK_SIZE, this, NETWORK_TASK_PRIORITY,
+                              &networkTaskHandle, 0) != pdPASS) {
+    // latched, a retry every loop would fail again: the network runs inline as without NETWORK_TASK_ENABLED
+    LOG_E("NETWORK", "Unable to start the network task, running the network in the loop task");
+    networkTaskHandle = nullptr;
+    networkTaskFailed = true;
+    return;
+  }
+  QueueManager::setNetworkTask(networkTaskHandle);
+}
+
+void BootstrapManager::networkTask(void *parameter) {
+  auto *bootstrapManager = static_cast<BootstrapManager *>(parameter);
+  esp_task_wdt_add(NULL);
+  for (;;) {
+    bootstrapManager->networkLoop(bootstrapManager->manageDisconnectionsFunction,
+                                  bootstrapManager->manageQueueSubscriptionFunction,
+                                  bootstrapManager->manageHardwareButtonFunction);
+    esp_task_wdt_reset();
+    vTaskDelay(1);
+  }
+}
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+void BootstrapManager::feedWatchdog() {
+  esp_task_wdt_reset();
+}
+#endif
+
+/********************************** SCHEDULE TASKS DRIVEN BY bootstrapLoop() **********************************/
+int16_t BootstrapManager::scheduleTask(unsigned long intervalMs, void (*task)(), unsigned long budgetMicros) {
+  return TaskScheduler::every(intervalMs, task, budgetMicros);
+}
+
+int16_t BootstrapManager::scheduleTaskOnce(unsigned long delayMs, void (*task)()) {
+  return TaskScheduler::once(delayMs, task);
+}
+
+bool BootstrapManager::cancelTask(int16_t taskId) {
+  return TaskScheduler::cancel(taskId);
 }
 
 /********************************** SET LAST WILL PARAMETERS IN THE Q MANAGER **********************************/
@@ -186,10 +327,7 @@ void BootstrapManager::setMQTTWill(const char *topic, const char *payload, const
 /********************************** SEND A SIMPLE MESSAGE ON THE QUEUE **********************************/
 void BootstrapManager::publish(const char *topic, const char *payload, boolean retained) {
   if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("QUEUE MSG SENT ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
-    Serial.println(payload);
+    LOG_I("MQTT", "QUEUE MSG SENT [%s] %s", topic, payload);
   }
   QueueManager::publish(topic, payload, retained);
 }
@@ -200,11 +338,7 @@ void BootstrapManager::publish(const char *topic, JsonObject objectToSend, boole
   serializeJson(objectToSend, buffer, sizeof(buffer));
   QueueManager::publish(topic, buffer, retained);
   if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("QUEUE MSG SENT ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
-    serializeJsonPretty(objectToSend, Serial);
-    Serial.println();
+    LOG_I("MQTT", "QUEUE MSG SENT [%s] %s", topic, buffer);
   }
 }
 
@@ -212,9 +346,7 @@ void BootstrapManager::publish(const char *topic, JsonObject objectToSend, boole
 void BootstrapManager::unsubscribe(const char *topic) {
   QueueManager::unsubscribe(topic);
   if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("TOPIC SUBSCRIBED ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
+    LOG_I("MQTT", "TOPIC SUBSCRIBED [%s]", topic);
   }
 }
 
@@ -222,9 +354,7 @@ void BootstrapManager::unsubscribe(const char *topic) {
 void BootstrapManager::subscribe(const char *topic) {
   QueueManager::subscribe(topic);
   if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("TOPIC SUBSCRIBED ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
+    LOG_I("MQTT", "TOPIC SUBSCRIBED [%s]", topic);
   }
 }
 
@@ -232,67 +362,29 @@ void BootstrapManager::subscribe(const char *topic) {
 void BootstrapManager::subscribe(const char *topic, uint8_t qos) {
   QueueManager::subscribe(topic, qos);
   if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("TOPIC SUBSCRIBED ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
+    LOG_I("MQTT", "TOPIC SUBSCRIBED [%s]", topic);
   }
 }
 
-/********************************** PRINT THE MESSAGE ARRIVING FROM THE QUEUE **********************************/
+/********************************** PARSE A MESSAGE INTO jsonDoc **********************************/
+JsonVariantConst BootstrapManager::parseQueueMsgRef(const char *topic, const byte *payload, unsigned int length) {
+  return messageParser.parseQueueMsgRef(topic, payload, length);
+}
+
 JsonDocument BootstrapManager::parseQueueMsg(char *topic, byte *payload, unsigned int length) {
-  if (DEBUG_QUEUE_MSG) {
-    Serial.print(F("QUEUE MSG ARRIVED ["));
-    Serial.print(topic);
-    Serial.println(F("] "));
-  }
-  char message[length + 1];
-  for (unsigned int i = 0; i < length; i++) {
-    message[i] = (char) payload[i];
-  }
-  message[length] = '\0';
-  DeserializationError error = deserializeJson(jsonDoc, (const byte *) payload, length);
-  // non json msg
-  if (error) {
-    JsonObject root = jsonDoc.to<JsonObject>();
-    root[VALUE] = message;
-    if (DEBUG_QUEUE_MSG) {
-      String msg = root[VALUE];
-      Serial.println(msg);
-    }
-    return jsonDoc;
-  } else { // return json doc
-    if (DEBUG_QUEUE_MSG) {
-      serializeJsonPretty(jsonDoc, Serial);
-      Serial.println();
-    }
-    return jsonDoc;
-  }
+  return messageParser.parseQueueMsg(topic, payload, length);
+}
+
+JsonVariantConst BootstrapManager::parseHttpMsgRef(const char *payload, size_t length) {
+  return messageParser.parseHttpMsgRef(payload, length);
+}
+
+JsonVariantConst BootstrapManager::parseHttpMsgRef(const String &payload) {
+  return messageParser.parseHttpMsgRef(payload);
 }
 
-/********************************** PRINT THE MESSAGE ARRIVING FROM HTTP **********************************/
 JsonDocument BootstrapManager::parseHttpMsg(String payload, unsigned int length) {
-  char message[length + 1];
-  for (unsigned int i = 0; i < length; i++) {
-    message[i] = (char) payload[i];
-  }
-  message[length] = '\0';
-  DeserializationError error = deserializeJson(jsonDoc, payload.c_str(), length);
-  // non json msg
-  if (error) {
-    JsonObject root = jsonDoc.to<JsonObject>();
-    root[VALUE] = message;
-    if (DEBUG_QUEUE_MSG) {
-      String msg = root[VALUE];
-      Serial.println(msg);
-    }
-    return jsonDoc;
-  } else { // return json doc
-    if (DEBUG_QUEUE_MSG) {
-      serializeJsonPretty(jsonDoc, Serial);
-      Serial.println();
-    }
-    return jsonDoc;
-  }
+  return messageParser.parseHttpMsg(payload, length);
 }
 
 // return a new json object instance
@@ -323,98 +415,141 @@ JsonObject BootstrapManager::getJsonObject() {
 
 // Print or display microcontroller infos
 void BootstrapManager::getMicrocontrollerInfo() {
-  Helpers::smartPrint(F("Wifi: "));
-  Helpers::smartPrint(WifiManager::getQuality());
-  Helpers::smartPrintln(F("%"));
+  getMicrocontrollerInfo(Helpers::smartOutput());
+}
+
+// Print microcontroller infos on the given output
+void BootstrapManager::getMicrocontrollerInfo(Print &out) {
+  out.print(F("Wifi: "));
+  out.print(WifiManager::getQuality());
+  out.println(F("%"));
 #if defined(ESP8266)
-  Helpers::smartPrint(F("Heap: ")); Helpers::smartPrint(EspClass::getFreeHeap()/1024); Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Free Flash: ")); Helpers::smartPrint(EspClass::getFreeSketchSpace()/1024); Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Frequency: ")); Helpers::smartPrint(EspClass::getCpuFreqMHz()); Helpers::smartPrintln(F("MHz"));
-  Helpers::smartPrint(F("Flash: ")); Helpers::smartPrint(EspClass::getFlashChipSize()/1024); Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Sketch: ")); Helpers::smartPrint(EspClass::getSketchSize()/1024); Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("SDK: ")); Helpers::smartPrintln(EspClass::getSdkVersion());
+  out.print(F("Heap: ")); out.print(EspClass::getFreeHeap()/1024); out.println(F(" KB"));
+  out.print(F("Free Flash: ")); out.print(EspClass::getFreeSketchSpace()/1024); out.println(F(" KB"));
+  out.print(F("Frequency: ")); out.print(EspClass::getCpuFreqMHz()); out.println(F("MHz"));
+  out.print(F("Flash: ")); out.print(EspClass::getFlashChipSize()/1024); out.println(F(" KB"));
+  out.print(F("Sketch: ")); out.print(EspClass::getSketchSize()/1024); out.println(F(" KB"));
+  out.print(F("SDK: ")); out.println(EspClass::getSdkVersion());
 #elif defined(ARDUINO_ARCH_ESP32)
-  Helpers::smartPrint(F("Heap: "));
-  Helpers::smartPrint(ESP.getFreeHeap() / 1024);
-  Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Free Flash: "));
-  Helpers::smartPrint(ESP.getFreeSketchSpace() / 1024);
-  Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Frequency: "));
-  Helpers::smartPrint(ESP.getCpuFreqMHz());
-  Helpers::smartPrintln(F("MHz"));
-  Helpers::smartPrint(F("Flash: "));
-  Helpers::smartPrint(ESP.getFlashChipSize() / 1024);
-  Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("Sketch: "));
-  Helpers::smartPrint(ESP.getSketchSize() / 1024);
-  Helpers::smartPrintln(F(" KB"));
-  Helpers::smartPrint(F("SDK: "));
-  Helpers::smartPrintln(ESP.getSdkVersion());
-#endif
-  Helpers::smartPrintln(F("MAC: "));
-  Helpers::smartPrintln(WiFi.macAddress());
-  Helpers::smartPrint(F("IP: "));
-  Helpers::smartPrintln(microcontrollerIP);
-  // helper.smartPrint(F("Arduino Core: ")); helper.smartPrintln(ESP.getCoreVersion());
-  Helpers::smartPrintln(F("Last Boot: "));
-  Helpers::smartPrintln(lastBoot);
-  Helpers::smartPrintln(F("Last WiFi connection:"));
-  Helpers::smartPrintln(lastWIFiConnection);
-  Helpers::smartPrintln(F("Last MQTT connection:"));
-  Helpers::smartPrintln(lastMQTTConnection);
-}
-
-// Draw screensaver useful for OLED displays
+  out.print(F("Heap: "));
+  out.print(ESP.getFreeHeap() / 1024);
+  out.println(F(" KB"));
+  out.print(F("Free Flash: "));
+  out.print(ESP.getFreeSketchSpace() / 1024);
+  out.println(F(" KB"));
+  out.print(F("Frequency: "));
+  out.print(ESP.getCpuFreqMHz());
+  out.println(F("MHz"));
+  out.print(F("Flash: "));
+  out.print(ESP.getFlashChipSize() / 1024);
+  out.println(F(" KB"));
+  out.print(F("Sketch: "));
+  out.print(ESP.getSketchSize() / 1024);
+  out.println(F(" KB"));
+  out.print(F("SDK: "));
+  out.println(ESP.getSdkVersion());
+#endif
+  out.println(F("MAC: "));
+  out.println(WiFi.macAddress());
+  out.print(F("IP: "));
+  out.println(microcontrollerIP);
+  // out.print(F("Arduino Core: ")); out.println(ESP.getCoreVersion());
+  out.println(F("Last Boot: "));
+  out.println(lastBoot);
+  out.println(F("Last WiFi connection:"));
+  out.println(lastWIFiConnection);
+  out.println(F("Last MQTT connection:"));
+  out.println(lastMQTTConnection);
+}
+
+#if (DISPLAY_ENABLED)
+static uint8_t screenSaverFrame = 0;
+static unsigned long screenSaverNextFrame = 0;
+#endif
+
+// Draw screensaver useful for OLED displays, call it on every loop: it draws one frame when it's due and returns
 [[maybe_unused]] void BootstrapManager::drawScreenSaver(const String &txt) {
 #if (DISPLAY_ENABLED)
-  if (screenSaverTriggered) {
-    display.clearDisplay();
-    for (int i = 0; i < 50; i++) {
-      display.clearDisplay();
-      display.setTextSize(2);
-      display.setCursor(5,17);
-      display.fillRect(0, 0, display.width(), display.height(), i%2 != 0 ? WHITE : BLACK);
-      display.setTextColor(i%2 == 0 ? WHITE : BLACK);
-      display.drawRoundRect(0, 0, display.width()-1, display.height()-1, display.height()/4, i%2 == 0 ? WHITE : BLACK);
-      display.println(txt);
-      display.display();
-    }
+  if (!screenSaverTriggered) {
+    screenSaverFrame = 0;
+    return;
+  }
+  unsigned long now = millis();
+  if (screenSaverFrame > 0 && (long) (now - screenSaverNextFrame) < 0) {
+    return;
+  }
+  unsigned long frameStart = micros();
+  bool inverted = screenSaverFrame % 2 != 0;
+  display.clearDisplay();
+  display.setTextSize(2);
+  display.setCursor(5,17);
+  display.fillRect(0, 0, display.width(), display.height(), inverted ? WHITE : BLACK);
+  display.setTextColor(inverted ? BLACK : WHITE);
+  display.drawRoundRect(0, 0, display.width()-1, display.height()-1, display.height()/4, inverted ? BLACK : WHITE);
+  display.println(txt);
+  DisplayManager::markDirty();
+  DisplayManager::flush();
+  // a slow bus stretches the animation instead of the loop
+  unsigned long frameTime = (micros() - frameStart) / 1000;
+  screenSaverNextFrame = now + (1000 / SCREEN_SAVER_FPS) + (frameTime > SCREEN_SAVER_FRAME_BUDGET ? frameTime - SCREEN_SAVER_FRAME_BUDGET : 0);
+  screenSaverFrame++;
+  if (screenSaverFrame >= SCREEN_SAVER_FRAMES) {
     display.setTextColor(WHITE);
+    screenSaverFrame = 0;
     screenSaverTriggered = false;
   }
 #endif
 }
 
+#if (DISPLAY_ENABLED)
+// the info page is taller than the display, it's rendered off screen and only copied at the scroll offset every frame
+static uint8_t infoPageBuffer[SCREEN_WIDTH * INFO_PAGE_HEIGHT / 8];
+static PageCanvas infoPage(SCREEN_WIDTH, INFO_PAGE_HEIGHT, infoPageBuffer);
+static bool infoPageRendered = false;
+static unsigned long infoPageRenderedAt = 0;
+
+static void renderInfoPage(const String &softwareVersion, const String &author) {
+  infoPage.fillScreen(BLACK);
+  if (haVersion[0] != '\0') {
+    infoPage.drawBitmap((infoPage.width()-HABIGLOGOW)-1, 5, HABIGLOGO, HABIGLOGOW, HABIGLOGOH, 1);
+  }
+  infoPage.setTextColor(WHITE);
+  infoPage.setCursor(0, 0);
+  infoPage.setTextSize(1);
+  infoPage.print(deviceName); infoPage.print(F(" "));
+  infoPage.println(softwareVersion);
+  infoPage.print(F("by ")); infoPage.println(author);
+  infoPage.println(F(""));
+
+  if (haVersion[0] != '\0') {
+    infoPage.print(F("HA: ")); infoPage.print(F("(")); infoPage.print(haVersion); infoPage.println(F(")"));
+  }
+
+  BootstrapManager::getMicrocontrollerInfo(infoPage);
+
+  // add/remove 8 pixel for every line at 175, if you want to add a line 183, INFO_PAGE_HEIGHT must follow
+  infoPage.drawBitmap((((infoPage.width()/2)-(ARDUINOLOGOW/2))), 175, ARDUINOLOGO, ARDUINOLOGOW, ARDUINOLOGOH, 1);
+  infoPageRendered = true;
+  infoPageRenderedAt = millis();
+}
+#endif
+
 // draw some infos about your controller
 [[maybe_unused]] void BootstrapManager::drawInfoPage(const String &softwareVersion, const String &author) {
 #if (DISPLAY_ENABLED)
   yoffset -= 1;
-  // add/remove 8 pixel for every line yoffset <= -209, if you want to add a line yoffset <= -217
-  if (yoffset <= -209) {
+  // the page is scrolled out when yoffset reaches -(INFO_PAGE_HEIGHT + 1)
+  if (yoffset <= -(INFO_PAGE_HEIGHT + 1)) {
     yoffset = SCREEN_HEIGHT + 6;
     lastPageScrollTriggered = true;
   }
   int effectiveOffset = (yoffset >= 0 && !lastPageScrollTriggered) ? 0 : yoffset;
 
-  if (haVersion[0] != '\0') {
-    display.drawBitmap((display.width()-HABIGLOGOW)-1, effectiveOffset+5, HABIGLOGO, HABIGLOGOW, HABIGLOGOH, 1);
-  }
-  display.setCursor(0, effectiveOffset);
-  display.setTextSize(1);
-  display.print(deviceName); display.print(F(" "));
-  display.println(softwareVersion);
-  display.println("by " + author);
-  display.println(F(""));
-
-  if (haVersion[0] != '\0') {
-    display.print(F("HA: ")); display.print(F("(")); display.print(haVersion); display.println(F(")"));
+  // values like heap and wifi quality change slowly, no need to print them again on every scroll step
+  if (!infoPageRendered || millis() - infoPageRenderedAt >= INFO_PAGE_REFRESH_INTERVAL) {
+    renderInfoPage(softwareVersion, author);
   }
-
-  getMicrocontrollerInfo();
-
-  // add/remove 8 pixel for every line effectiveOffset+175, if you want to add a line effectiveOffset+183
-  display.drawBitmap((((display.width()/2)-(ARDUINOLOGOW/2))), effectiveOffset+175, ARDUINOLOGO, ARDUINOLOGOW, ARDUINOLOGOH, 1);
+  infoPage.blitTo(display.getBuffer(), display.height(), effectiveOffset);
 #endif
 }
 
@@ -426,6 +561,24 @@ void BootstrapManager::getMicrocontrollerInfo() {
   objectToSend["ver"] = version;
   objectToSend["time"] = timedate;
   objectToSend["wifi"] = WifiManager::getQuality();
+  HeapMonitor::addTo(objectToSend);
+#if (PING_INTERVAL > 0)
+  PingService::addTo(objectToSend);
+#endif
+#if (HEALTH_INTERVAL > 0)
+  HealthMonitor::addTo(objectToSend);
+#endif
+#if (ROAMING_CHECK_INTERVAL > 0)
+  RoamingManager::addTo(objectToSend);
+#endif
+  if (BrokerManager::getBrokerCount() > 1) {
+    BrokerManager::addTo(objectToSend);
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  if (ethd > 0) {
+    LinkManager::addTo(objectToSend);
+  }
+#endif
 
   // publish state only if it has received time from HA
   if (timedate != OFF_CMD) {
@@ -438,12 +591,12 @@ void BootstrapManager::getMicrocontrollerInfo() {
 void BootstrapManager::writeToLittleFS(const JsonDocument &jDoc, const String &filenameToUse) {
   File jsonFile = LittleFS.open("/" + filenameToUse, FILE_WRITE);
   if (!jsonFile) {
-    Helpers::smartPrintln("Failed to open [" + filenameToUse + "] file for writing");
+    Helpers::smartPrintf(PSTR("Failed to open [%s] file for writing\n"), filenameToUse.c_str());
   } else {
-    serializeJsonPretty(jDoc, Serial);
+    LOG_JSON_D("FS", jDoc);
     serializeJson(jDoc, jsonFile);
     jsonFile.close();
-    Helpers::smartPrintln("[" + filenameToUse + "] written correctly");
+    Helpers::smartPrintf(PSTR("[%s] written correctly\n"), filenameToUse.c_str());
   }
 }
 
@@ -460,18 +613,18 @@ JsonDocument BootstrapManager::readLittleFS(const String &filenameToUse) {
   helper.smartDisplay();
   File jsonFile = LittleFS.open("/" + filenameToUse, FILE_READ);
   if (!jsonFile) {
-    Helpers::smartPrintln("Failed to open [" + filenameToUse + "] file");
+    Helpers::smartPrintf(PSTR("Failed to open [%s] file\n"), filenameToUse.c_str());
     helper.smartDisplay();
   }
-  JsonDocument jsonDoc;
+  JsonDocument jsonDoc(&scratchArena);
   auto error = deserializeJson(jsonDoc, jsonFile);
-  if (filenameToUse != "setup.json") serializeJsonPretty(jsonDoc, Serial);
+  if (filenameToUse != "setup.json") LOG_JSON_D("FS", jsonDoc);
   jsonFile.close();
   if (error) {
-    Helpers::smartPrintln("Failed to parse [" + filenameToUse + "] file");
+    Helpers::smartPrintf(PSTR("Failed to parse [%s] file\n"), filenameToUse.c_str());
     helper.smartDisplay(DELAY_2000);
   } else {
-    Helpers::smartPrintln("[" + filenameToUse + "]\nJSON parsed");
+    Helpers::smartPrintf(PSTR("[%s]\nJSON parsed\n"), filenameToUse.c_str());
     helper.smartDisplay(DELAY_2000);
     return jsonDoc;
   }
@@ -486,12 +639,12 @@ String BootstrapManager::readValueFromFile(const String &filenameToUse, const St
   }
   File jsonFile = LittleFS.open("/" + filenameToUse, FILE_READ);
   if (!jsonFile) {
-    Helpers::smartPrintln("Failed to open [" + filenameToUse + "] file");
+    Helpers::smartPrintf(PSTR("Failed to open [%s] file\n"), filenameToUse.c_str());
     helper.smartDisplay();
   }
-  JsonDocument jDoc;
+  JsonDocument jDoc(&scratchArena);
   auto error = deserializeJson(jDoc, jsonFile);
-  serializeJsonPretty(jDoc, Serial);
+  LOG_JSON_D("FS", jDoc);
   JsonVariant answer = jDoc[paramName];
   if (answer.is<const char*>()) {
     returnStr = String(answer.as<const char*>());
@@ -520,9 +673,12 @@ bool BootstrapManager::isWifiConfigured() {
         microcontrollerIP = IP_MICROCONTROLLER;
         qsid = SSID;
         qpass = PASSWORD;
+        RoamingManager::clearNetworks();
+        RoamingManager::addNetwork(qsid.c_str(), qpass.c_str());
         OTApass = OTAPASSWORD;
         mqttIP = MQTT_SERVER;
         mqttPort = MQTT_PORT;
+        BrokerManager::clearBrokers();
         mqttuser = MQTT_USERNAME;
         mqttpass = MQTT_PASSWORD;
         additionalParam = PARAM_ADDITIONAL;
@@ -531,19 +687,25 @@ bool BootstrapManager::isWifiConfigured() {
         JsonDocument mydoc = readLittleFS(F("setup.json"));
         if (mydoc[F("qsid")].is<JsonVariant>()) {
             Serial.println(F("Storage OK, restoring WiFi and MQTT config."));
-            microcontrollerIP = Helpers::getValue(mydoc["microcontrollerIP"]);
-            qsid = Helpers::getValue(mydoc[F("qsid")]);
-            qpass = Helpers::getValue(mydoc[F("qpass")]);
-            OTApass = Helpers::getValue(mydoc[F("OTApass")]);
+            Helpers::readConfig(microcontrollerIP, mydoc["microcontrollerIP"], "microcontrollerIP");
+            Helpers::readConfig(qsid, mydoc[F("qsid")], "qsid");
+            Helpers::readConfig(qpass, mydoc[F("qpass")], "qpass");
+            RoamingManager::clearNetworks();
+            RoamingManager::addNetwork(qsid.c_str(), qpass.c_str());
+            RoamingManager::addNetworks(mydoc[F("networks")].as<JsonArrayConst>());
+            Helpers::readConfig(OTApass, mydoc[F("OTApass")], "OTApass");
             if (OTApass.isEmpty()) {
               OTApass = OTAPASSWORD;
             }
-            mqttIP = Helpers::getValue(mydoc[F("mqttIP")]);
-            mqttPort = Helpers::getValue(mydoc[F("mqttPort")]);
-            mqttuser = Helpers::getValue(mydoc[F("mqttuser")]);
-            mqttpass = Helpers::getValue(mydoc[F("mqttpass")]);
-            additionalParam = Helpers::getValue(mydoc[F("additionalParam")]);
-            deviceName = Helpers::getValue(mydoc[F("deviceName")]);
+            Helpers::readConfig(mqttIP, mydoc[F("mqttIP")], "mqttIP");
+            Helpers::readConfig(mqttPort, mydoc[F("mqttPort")], "mqttPort");
+            BrokerManager::clearBrokers();
+            BrokerManager::addBroker(mqttIP.c_str(), bootstrapConfig.getMqttPort());
+            BrokerManager::addBrokers(mydoc[F("brokers")].as<JsonArrayConst>());
+            Helpers::readConfig(mqttuser, mydoc[F("mqttuser")], "mqttuser");
+            Helpers::readConfig(mqttpass, mydoc[F("mqttpass")], "mqttpass");
+            Helpers::readConfig(additionalParam, mydoc[F("additionalParam")], "additionalParam");
+            Helpers::readConfig(deviceName, mydoc[F("deviceName")], "deviceName");
             ethd = mydoc[F("ethd")].as<int8_t>();
 #if defined(ARDUINO_ARCH_ESP32)
             if (ethd == spiStartIdx) {
@@ -551,6 +713,8 @@ bool BootstrapManager::isWifiConfigured() {
               miso = mydoc[F("miso")].as<int8_t>();
               sclk = mydoc[F("sclk")].as<int8_t>();
               cs = mydoc[F("cs")].as<int8_t>();
+              interrupt = mydoc[F("int")].is<JsonVariant>() ? mydoc[F("int")].as<int8_t>() : -1;
+              rst = mydoc[F("rst")].is<JsonVariant>() ? mydoc[F("rst")].as<int8_t>() : -1;
             }
 #endif
 #if defined(ESP8266)
@@ -30,8 +30,22 @@
 #include "Helpers.h"
 #include "WifiManager.h"
 #include "QueueManager.h"
+#include "TaskScheduler.h"
+#include "LoopProfiler.h"
+#include "Logger.h"
+#include "HeapMonitor.h"
+#include "JsonArena.h"
+#include "MessageParser.h"
+#include "PageCanvas.h"
+#include "DisplayManager.h"
+#include "PingService.h"
+#include "HealthMonitor.h"
+#include "RoamingManager.h"
+#include "BrokerManager.h"
+#include "OtaManager.h"
 #if defined(ARDUINO_ARCH_ESP32)
 #include "EthManager.h"
+#include "LinkManager.h"
 #include <esp_task_wdt.h>
 #endif
 
@@ -42,15 +56,30 @@ private:
     QueueManager queueManager; // QueueManager classes for MQTT queue management
     Helpers helper;
 #if defined(ARDUINO_ARCH_ESP32)
-    unsigned long lastMillisForWdt = millis();
+    static void feedWatchdog(); // reset the task watchdog of the loop task
 #endif
+#if (NETWORK_TASK_ACTIVE)
+    TaskHandle_t networkTaskHandle = nullptr;
+    bool networkTaskFailed = false; // the task couldn't be created, networkLoop() runs in bootstrapLoop()
+    void (*manageDisconnectionsFunction)() = nullptr;
+    void (*manageQueueSubscriptionFunction)() = nullptr;
+    void (*manageHardwareButtonFunction)() = nullptr;
+    void startNetworkTask(void (*manageDisconnections)(), void (*manageQueueSubscription)(), void (*manageHardwareButton)());
+    static void networkTask(void *parameter);
+#endif
+    void networkLoop(void (*manageDisconnections)(), void (*manageQueueSubscription)(), void (*manageHardwareButton)()); // WiFi, Improv, OTA and MQTT
+    MessageParser messageParser{jsonDoc}; // parses into jsonDoc
 
 public:
-    JsonDocument jsonDoc;
-    JsonDocument jsonDocBigSize;
+    JsonDocument jsonDoc{&messageArena};
+    JsonDocument jsonDocBigSize{&bigArena};
     // using JsonDocument = StaticJsonDocument<BUFFER_SIZE>;
-    JsonDocument parseQueueMsg(char* topic, byte* payload, unsigned int length); // print the message arriving from the queue
-    JsonDocument parseHttpMsg(String payload, unsigned int length); // print the message arriving from HTTP
+    // parse the message into jsonDoc and return a view of it, valid until the next message is parsed, no copies
+    JsonVariantConst parseQueueMsgRef(const char* topic, const byte* payload, unsigned int length);
+    JsonVariantConst parseHttpMsgRef(const char* payload, size_t length);
+    JsonVariantConst parseHttpMsgRef(const String& payload);
+    JsonDocument parseQueueMsg(char* topic, byte* payload, unsigned int length); // copy of the parsed message, prefer parseQueueMsgRef()
+    JsonDocument parseHttpMsg(String payload, unsigned int length); // copy of the parsed message, prefer parseHttpMsgRef()
     void littleFsInit();
     void bootstrapSetup(void (*manageDisconnectionFunction)(), void (*manageHardwareButton)(), void (*callback)(char*, byte*, unsigned int)); // bootstrap setup()
     void bootstrapSetup(void (*manageDisconnectionFunction)(), void (*manageHardwareButton)(), void (*callback)(char*, byte*, unsigned int), bool waitImprov, void (*listener)()); // bootstrap setup()
@@ -64,6 +93,7 @@ public:
     JsonObject getJsonObject(); // return a new json object instance
     [[maybe_unused]] static void nonBlokingBlink(); // blink default LED when sending data to the queue
     [[maybe_unused]] static void getMicrocontrollerInfo(); // print or display microcontroller's info
+    static void getMicrocontrollerInfo(Print &out); // print microcontroller's info on the given output
     [[maybe_unused]] void drawInfoPage(const String& softwareVersion, const String& author); // draw a page with all the microcontroller's info
     [[maybe_unused]] void drawScreenSaver(const String& txt); // useful for OLED displays
     [[maybe_unused]] static void sendState(const char *topic, JsonObject objectToSend, const String& version); // send microcontroller's info on the queue
@@ -76,6 +106,9 @@ public:
     static int getWifiQuality(); // get the wifi quality
     void manageImprov();
     static void initMqttOta(void (*callback)(char *, byte *, unsigned int)) ;
+    static int16_t scheduleTask(unsigned long intervalMs, void (*task)(), unsigned long budgetMicros = 0); // run a task periodically from bootstrapLoop()
+    static int16_t scheduleTaskOnce(unsigned long delayMs, void (*task)()); // run a task once from bootstrapLoop()
+    static bool cancelTask(int16_t taskId); // remove a scheduled task
 };
 
 #endif
\ No newline at end of file
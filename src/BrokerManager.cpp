@@ -0,0 +1,308 @@
+/*
+  BrokerManager.cpp - MQTT broker list with failover and fail-back
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "BrokerManager.h"
+#include "Helpers.h"
+#include "Logger.h"
+#include "WifiManager.h"
+#if defined(ESP8266)
+#include <lwip/tcp.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#endif
+
+enum FailbackProbeState {
+    Failback_Idle,
+    Failback_Connecting,
+    Failback_Reachable,
+    Failback_Unreachable
+};
+
+// TCP connection to the primary broker, opened without blocking and polled by loop()
+#if defined(ESP8266)
+static tcp_pcb *probePcb = nullptr;
+static volatile uint8_t probeState = Failback_Idle;
+
+static err_t probeConnected(void *arg, tcp_pcb *pcb, err_t err) {
+  // the connection is not used, lwIP wants it aborted from the callback
+  tcp_err(pcb, nullptr);
+  tcp_abort(pcb);
+  probePcb = nullptr;
+  probeState = Failback_Reachable;
+  return ERR_ABRT;
+}
+
+static void probeError(void *arg, err_t err) {
+  // lwIP has already freed the pcb
+  probePcb = nullptr;
+  probeState = Failback_Unreachable;
+}
+
+static bool probeStart(const IPAddress &ip, uint16_t port) {
+  probePcb = tcp_new();
+  if (probePcb == nullptr) return false;
+  tcp_err(probePcb, probeError);
+  ip_addr_t address;
+  IP_ADDR4(&address, ip[0], ip[1], ip[2], ip[3]);
+  probeState = Failback_Connecting;
+  if (tcp_connect(probePcb, &address, port, probeConnected) != ERR_OK) {
+    tcp_err(probePcb, nullptr);
+    tcp_abort(probePcb);
+    probePcb = nullptr;
+    probeState = Failback_Idle;
+    return false;
+  }
+  return true;
+}
+
+static uint8_t probePoll() {
+  return probeState;
+}
+
+static void probeStop() {
+  if (probePcb != nullptr) {
+    tcp_err(probePcb, nullptr);
+    tcp_abort(probePcb);
+    probePcb = nullptr;
+  }
+  probeState = Failback_Idle;
+}
+#elif defined(ARDUINO_ARCH_ESP32)
+static int probeSocket = -1;
+static uint8_t probeState = Failback_Idle;
+
+static void probeStop() {
+  if (probeSocket >= 0) {
+    lwip_close(probeSocket);
+    probeSocket = -1;
+  }
+  probeState = Failback_Idle;
+}
+
+static bool probeStart(const IPAddress &ip, uint16_t port) {
+  probeSocket = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (probeSocket < 0) return false;
+  lwip_fcntl(probeSocket, F_SETFL, lwip_fcntl(probeSocket, F_GETFL, 0) | O_NONBLOCK);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = (uint32_t) ip;
+  if (lwip_connect(probeSocket, (sockaddr *) &address, sizeof(address)) == 0) {
+    probeState = Failback_Reachable;
+  } else if (errno == EINPROGRESS) {
+    probeState = Failback_Connecting;
+  } else {
+    probeStop();
+    return false;
+  }
+  return true;
+}
+
+static uint8_t probePoll() {
+  if (probeState != Failback_Connecting) return probeState;
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(probeSocket, &writable);
+  timeval noWait = {0, 0};
+  if (lwip_select(probeSocket + 1, nullptr, &writable, nullptr, &noWait) > 0) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    lwip_getsockopt(probeSocket, SOL_SOCKET, SO_ERROR, &error, &length);
+    probeState = error == 0 ? Failback_Reachable : Failback_Unreachable;
+  }
+  return probeState;
+}
+#endif
+
+BrokerManager::Broker BrokerManager::brokers[MQTT_MAX_BROKERS];
+uint8_t BrokerManager::brokerCount = 0;
+uint8_t BrokerManager::active = 0;
+uint8_t BrokerManager::failures = 0;
+unsigned long BrokerManager::connectedSince = 0;
+unsigned long BrokerManager::lastFailbackProbe = 0;
+uint32_t BrokerManager::switches = 0;
+
+void BrokerManager::clearBrokers() {
+  brokerCount = 0;
+  active = 0;
+  failures = 0;
+}
+
+bool BrokerManager::addBroker(const char *host, uint16_t port) {
+  if (brokerCount >= MQTT_MAX_BROKERS || host == nullptr || host[0] == '\0') {
+    return false;
+  }
+  if (strlen(host) > decltype(Broker::host)::capacity()) {
+    LOG_E("MQTT", "Broker name too long: %s", host);
+    return false;
+  }
+  Broker &broker = brokers[brokerCount];
+  broker.host = host;
+  broker.port = port > 0 ? port : 1883;
+  broker.ip = IPAddress(0, 0, 0, 0);
+  broker.resolvedAt = 0;
+  broker.stats = {};
+  brokerCount++;
+  return true;
+}
+
+void BrokerManager::addBrokers(JsonArrayConst list) {
+  for (JsonObjectConst broker : list) {
+    addBroker(broker[F("mqttIP")], broker[F("mqttPort")].as<uint16_t>());
+  }
+}
+
+void BrokerManager::begin(PubSubClient &client) {
+  if (brokerCount == 0) {
+    addBroker(mqttIP.c_str(), bootstrapConfig.getMqttPort());
+  }
+  useBroker(0);
+  beforeConnect(client);
+}
+
+// IP addresses are parsed once, hostnames are resolved again when the cache expires
+bool BrokerManager::resolve(Broker &broker) {
+  if (broker.resolvedAt != 0 && millis() - broker.resolvedAt < MQTT_DNS_TTL) {
+    return true;
+  }
+  IPAddress ip;
+  if (ip.fromString(broker.host.c_str())) {
+    broker.ip = ip;
+    broker.resolvedAt = millis();
+    return true;
+  }
+  if (WiFi.hostByName(broker.host.c_str(), ip) == 1 && ip != IPAddress(0, 0, 0, 0)) {
+    broker.ip = ip;
+    broker.resolvedAt = millis();
+    return true;
+  }
+  LOG_W("MQTT", "Unable to resolve %s", broker.host.c_str());
+  // keep the last address, if any
+  return broker.ip != IPAddress(0, 0, 0, 0);
+}
+
+void BrokerManager::useBroker(uint8_t index) {
+  connectionLost();
+  if (index != active) {
+    switches++;
+    LOG_W("MQTT", "Switching to broker %u: %s:%u", index, brokers[index].host.c_str(), brokers[index].port);
+  }
+  active = index;
+  failures = 0;
+  lastFailbackProbe = millis();
+}
+
+void BrokerManager::beforeConnect(PubSubClient &client) {
+  if (brokerCount == 0) return;
+  Broker &broker = brokers[active];
+  resolve(broker);
+#if (MQTT_TLS)
+  // TLS connects by name, the hostname is sent as SNI and checked against the broker certificate
+  client.setServer(broker.host.c_str(), broker.port);
+#else
+  client.setServer(broker.ip, broker.port);
+#endif
+}
+
+void BrokerManager::connectResult(PubSubClient &client, bool connected) {
+  if (brokerCount == 0) return;
+  Broker &broker = brokers[active];
+  if (connected) {
+    broker.stats.connections++;
+    failures = 0;
+    connectedSince = millis();
+    return;
+  }
+  broker.stats.failures++;
+  if (++failures >= MQTT_BROKER_FAILURES && brokerCount > 1) {
+    // the cached address may be stale, it is resolved again when the broker is used next time
+    broker.resolvedAt = 0;
+    useBroker((active + 1) % brokerCount);
+  }
+}
+
+void BrokerManager::connectionLost() {
+  if (connectedSince == 0) return;
+  brokers[active].stats.connectedMs += millis() - connectedSince;
+  connectedSince = 0;
+}
+
+void BrokerManager::loop(PubSubClient &client) {
+#if (MQTT_FAILBACK_INTERVAL > 0)
+  if (active == 0 || brokerCount < 2) {
+    probeStop();
+    return;
+  }
+  // a TCP connection is enough to know that the primary is back, it is polled without blocking the loop
+  if (probeState != Failback_Idle) {
+    uint8_t state = probePoll();
+    if (state == Failback_Connecting && millis() - lastFailbackProbe < MQTT_FAILBACK_PROBE_TIMEOUT) return;
+    probeStop();
+    if (state == Failback_Reachable) {
+      useBroker(0);
+      client.disconnect();
+    }
+    return;
+  }
+  if (millis() - lastFailbackProbe < MQTT_FAILBACK_INTERVAL) return;
+  lastFailbackProbe = millis();
+  Broker &primary = brokers[0];
+  // hostByName() blocks, the probe uses the last known address and the connection resolves the name again
+  IPAddress ip;
+  if (ip.fromString(primary.host.c_str())) primary.ip = ip;
+  if (primary.ip == IPAddress(0, 0, 0, 0)) return;
+  probeStart(primary.ip, primary.port);
+#endif
+}
+
+uint8_t BrokerManager::getActiveBroker() {
+  return active;
+}
+
+IPAddress BrokerManager::getActiveIp() {
+  return brokerCount > 0 ? brokers[active].ip : IPAddress(0, 0, 0, 0);
+}
+
+const char *BrokerManager::getActiveHost() {
+  return brokerCount > 0 ? brokers[active].host.c_str() : "";
+}
+
+uint16_t BrokerManager::getActivePort() {
+  return brokerCount > 0 ? brokers[active].port : 0;
+}
+
+uint8_t BrokerManager::getBrokerCount() {
+  return brokerCount;
+}
+
+const BrokerStats *BrokerManager::getStats(uint8_t index) {
+  return index < brokerCount ? &brokers[index].stats : nullptr;
+}
+
+void BrokerManager::addTo(JsonObject object) {
+  object["broker"] = active;
+  object["brokerSwitches"] = switches;
+  // seconds connected to every broker, the current connection included
+  JsonArray time = object["brokerTime"].to<JsonArray>();
+  for (uint8_t i = 0; i < brokerCount; i++) {
+    uint32_t connectedMs = brokers[i].stats.connectedMs;
+    if (i == active && connectedSince != 0) connectedMs += millis() - connectedSince;
+    time.add(connectedMs / 1000);
+  }
+}
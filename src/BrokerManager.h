@@ -0,0 +1,98 @@
+/*
+  BrokerManager.h - MQTT broker list with failover and fail-back
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_BROKER_MANAGER_H
+#define _DPSOFTWARE_BROKER_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <IPAddress.h>
+#include <PubSubClient.h>
+#include "Configuration.h"
+#include "FixedString.h"
+
+struct BrokerStats {
+    uint32_t connections; // successful connections
+    uint32_t failures; // failed connections
+    uint32_t connectedMs; // time spent connected to this broker
+};
+
+/*
+  Ordered list of MQTT brokers, mqttIP/mqttPort first and then the "brokers" list of the setup file:
+    "brokers": [{"mqttIP": "backup.local", "mqttPort": "1883"}]
+  Brokers are IP addresses or hostnames, hostnames are resolved before connecting and cached for MQTT_DNS_TTL milliseconds.
+  After MQTT_BROKER_FAILURES failed connections in a row the next broker is used. While connected to a backup broker
+  the primary is probed every MQTT_FAILBACK_INTERVAL milliseconds and the client moves back to it when it answers.
+*/
+class BrokerManager {
+
+private:
+    struct Broker {
+        FixedString<254> host; // a full DNS name
+        uint16_t port;
+        IPAddress ip;
+        unsigned long resolvedAt;
+        BrokerStats stats;
+    };
+
+    static Broker brokers[MQTT_MAX_BROKERS];
+    static uint8_t brokerCount;
+    static uint8_t active;
+    static uint8_t failures; // consecutive failures on the active broker
+    static unsigned long connectedSince; // 0 when not connected
+    static unsigned long lastFailbackProbe;
+    static uint32_t switches;
+
+    static bool resolve(Broker &broker);
+
+    static void useBroker(uint8_t index);
+
+public:
+    static void clearBrokers();
+
+    static bool addBroker(const char *host, uint16_t port); // false when the list is full
+
+    static void addBrokers(JsonArrayConst list); // the "brokers" list of the setup file
+
+    static void begin(PubSubClient &client); // add the configured broker if the list is empty, use the first one
+
+    static void beforeConnect(PubSubClient &client); // resolve the active broker, called before every connection
+
+    static void connectResult(PubSubClient &client, bool connected); // count the result, fail over when needed
+
+    static void connectionLost(); // the client is not connected, stop the connected time
+
+    static void loop(PubSubClient &client); // fail-back probe of the primary, called while connected
+
+    static uint8_t getActiveBroker();
+
+    static IPAddress getActiveIp(); // resolved address of the active broker
+
+    static const char *getActiveHost(); // hostname or IP address as configured
+
+    static uint16_t getActivePort();
+
+    static uint8_t getBrokerCount();
+
+    static const BrokerStats *getStats(uint8_t index);
+
+    static void addTo(JsonObject object); // broker fields for the state message
+};
+
+#endif
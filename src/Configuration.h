@@ -46,6 +46,44 @@
 #define DEBUG_QUEUE_MSG false
 #endif
 
+// Max log level compiled into the firmware: 0 none, 1 error, 2 warning, 3 info, 4 debug, 5 verbose
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 3
+#endif
+
+// Log lines are queued in a ring buffer and written to Serial by bootstrapLoop() without blocking
+#ifndef LOG_BUFFER_SIZE
+#if defined(ESP8266)
+#define LOG_BUFFER_SIZE 1024
+#else
+#define LOG_BUFFER_SIZE 4096
+#endif
+#endif
+
+// Max length of a formatted log line, longer lines are truncated
+#ifndef LOG_LINE_SIZE
+#define LOG_LINE_SIZE 192
+#endif
+
+// Syslog server IP address where the log lines are sent via UDP, empty to disable
+#ifndef LOG_SYSLOG_SERVER
+#define LOG_SYSLOG_SERVER ""
+#endif
+
+#ifndef LOG_SYSLOG_PORT
+#define LOG_SYSLOG_PORT 514
+#endif
+
+// MQTT topic where the log lines are published, empty to disable
+#ifndef LOG_MQTT_TOPIC
+#define LOG_MQTT_TOPIC ""
+#endif
+
+// Max number of log lines sent to syslog or MQTT for every bootstrapLoop()
+#ifndef LOG_REMOTE_BATCH
+#define LOG_REMOTE_BATCH 4
+#endif
+
 // Specify if you want to use a display or only Serial
 #ifndef DISPLAY_ENABLED
 #define DISPLAY_ENABLED false
@@ -60,6 +98,41 @@
 extern Adafruit_SSD1306 display;
 #endif
 
+// smartDisplay() sends the framebuffer to the display at most once every DISPLAY_FRAME_INTERVAL milliseconds
+#ifndef DISPLAY_FRAME_INTERVAL
+#define DISPLAY_FRAME_INTERVAL 50
+#endif
+
+// Send only the part of the framebuffer that changed since the last transfer, uses SCREEN_WIDTH * SCREEN_HEIGHT / 8 bytes of RAM
+#ifndef DISPLAY_PARTIAL_FLUSH
+#define DISPLAY_PARTIAL_FLUSH false
+#endif
+
+// Number of frames of the screensaver animation started by screenSaverTriggered
+#ifndef SCREEN_SAVER_FRAMES
+#define SCREEN_SAVER_FRAMES 50
+#endif
+
+// Target frame rate of the screensaver animation, one frame is drawn per drawScreenSaver() call at most
+#ifndef SCREEN_SAVER_FPS
+#define SCREEN_SAVER_FPS 20
+#endif
+
+// Milliseconds a screensaver frame may take to draw and transfer, the next frame is postponed by the excess
+#ifndef SCREEN_SAVER_FRAME_BUDGET
+#define SCREEN_SAVER_FRAME_BUDGET 30
+#endif
+
+// Height in pixels of the info page, rendered off screen and scrolled by drawInfoPage()
+#ifndef INFO_PAGE_HEIGHT
+#define INFO_PAGE_HEIGHT 208
+#endif
+
+// The info page is rendered again with fresh values every INFO_PAGE_REFRESH_INTERVAL milliseconds
+#ifndef INFO_PAGE_REFRESH_INTERVAL
+#define INFO_PAGE_REFRESH_INTERVAL 5000
+#endif
+
 // Values greater then 0 enables Improv for that milliseconds period
 #ifndef IMPROV_ENABLED
 #define IMPROV_ENABLED 0
@@ -145,6 +218,295 @@ const char *const MQTT_PORT = MQTT_SERVER_PORT;
 #define MQTT_KEEP_ALIVE 60
 #endif
 
+// Maximum number of tasks registered in the scheduler
+#ifndef MAX_SCHEDULED_TASKS
+#define MAX_SCHEDULED_TASKS 16
+#endif
+
+// Scheduler resolution in milliseconds
+#ifndef SCHEDULER_TICK
+#define SCHEDULER_TICK 10
+#endif
+
+// ESP32 only, run WiFi, MQTT, OTA and Improv in a FreeRTOS task pinned to core 0 leaving core 1 to the application.
+// manageDisconnections(), manageQueueSubscription() and manageHardwareButton() are called from the network task,
+// the MQTT callback is called from bootstrapLoop().
+#ifndef NETWORK_TASK_ENABLED
+#define NETWORK_TASK_ENABLED false
+#endif
+#if (NETWORK_TASK_ENABLED) && defined(ARDUINO_ARCH_ESP32) && !CONFIG_FREERTOS_UNICORE
+#define NETWORK_TASK_ACTIVE true
+#else
+#define NETWORK_TASK_ACTIVE false
+#endif
+
+// Stack size of the network task
+#ifndef NETWORK_TASK_STACK_SIZE
+#define NETWORK_TASK_STACK_SIZE 8192
+#endif
+
+// Priority of the network task
+#ifndef NETWORK_TASK_PRIORITY
+#define NETWORK_TASK_PRIORITY 1
+#endif
+
+// Number of preallocated MQTT messages in every message queue, must be a power of two
+#ifndef MESSAGE_QUEUE_SIZE
+#define MESSAGE_QUEUE_SIZE 8
+#endif
+
+// WiFi and link actions posted by the loop task to the network task, must be a power of two
+#ifndef NETWORK_ACTION_QUEUE_SIZE
+#define NETWORK_ACTION_QUEUE_SIZE 8
+#endif
+
+// Max topic length of a queued MQTT message
+#ifndef MESSAGE_QUEUE_TOPIC_SIZE
+#define MESSAGE_QUEUE_TOPIC_SIZE 128
+#endif
+
+// Max payload length of a queued MQTT message
+#ifndef MESSAGE_QUEUE_PAYLOAD_SIZE
+#define MESSAGE_QUEUE_PAYLOAD_SIZE 512
+#endif
+
+// Copy the received MQTT messages in a queue drained by bootstrapLoop() instead of calling the callback inside the MQTT client,
+// slow callbacks can't delay keep alives and payloads stay valid until the callback returns. Always enabled with the network task.
+#ifndef INBOUND_QUEUE_ENABLED
+#define INBOUND_QUEUE_ENABLED false
+#endif
+#if (INBOUND_QUEUE_ENABLED) || (NETWORK_TASK_ACTIVE)
+#define INBOUND_QUEUE_ACTIVE true
+#else
+#define INBOUND_QUEUE_ACTIVE false
+#endif
+
+// What to do when a message is received and the inbound queue is full:
+// 0 drop the new message, 1 drop the oldest queued message (not available with the network task, the new one is dropped),
+// 2 wait up to INBOUND_QUEUE_BLOCK_TIMEOUT for the application to make room (network task only, the new one is dropped otherwise)
+#ifndef INBOUND_QUEUE_POLICY
+#define INBOUND_QUEUE_POLICY 0
+#endif
+
+// Max milliseconds the network task waits for room in the inbound queue
+#ifndef INBOUND_QUEUE_BLOCK_TIMEOUT
+#define INBOUND_QUEUE_BLOCK_TIMEOUT 50
+#endif
+
+// Max number of messages delivered to the callback for every bootstrapLoop(), 0 to deliver all the queued messages
+#ifndef INBOUND_QUEUE_BATCH
+#define INBOUND_QUEUE_BATCH 0
+#endif
+
+// Measure the time spent in every bootstrapLoop() stage, no code is generated when disabled
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED false
+#endif
+
+// Loop profiler report interval in milliseconds
+#ifndef LOOP_PROFILER_INTERVAL
+#define LOOP_PROFILER_INTERVAL 60000
+#endif
+
+// MQTT topic where the loop profiler report is published, empty to print it on Serial only
+#ifndef LOOP_PROFILER_TOPIC
+#define LOOP_PROFILER_TOPIC ""
+#endif
+
+// Preallocated arenas used by the library JSON documents, 0 to use the heap, when an arena is full the heap is used
+// jsonDoc, the document holding the last received message
+#ifndef JSON_ARENA_SIZE
+#if defined(ESP8266)
+#define JSON_ARENA_SIZE 2048
+#else
+#define JSON_ARENA_SIZE 4096
+#endif
+#endif
+
+// jsonDocBigSize
+#ifndef JSON_BIG_ARENA_SIZE
+#define JSON_BIG_ARENA_SIZE 0
+#endif
+
+// Short lived documents: config files, Improv provisioning, web server settings, reports
+#ifndef JSON_SCRATCH_ARENA_SIZE
+#if defined(ESP8266)
+#define JSON_SCRATCH_ARENA_SIZE 2048
+#else
+#define JSON_SCRATCH_ARENA_SIZE 4096
+#endif
+#endif
+
+// Heap sampling interval in milliseconds, 0 to disable the heap monitor
+#ifndef HEAP_MONITOR_INTERVAL
+#define HEAP_MONITOR_INTERVAL 10000
+#endif
+
+// Heap is unhealthy when the largest free block is smaller than this value in bytes, 0 to disable the check
+#ifndef HEAP_MONITOR_MIN_BLOCK
+#define HEAP_MONITOR_MIN_BLOCK 0
+#endif
+
+// Heap is unhealthy when the fragmentation percentage is greater than this value, 0 to disable the check
+#ifndef HEAP_MONITOR_MAX_FRAGMENTATION
+#define HEAP_MONITOR_MAX_FRAGMENTATION 0
+#endif
+
+// Number of consecutive unhealthy samples that trigger the threshold callback
+#ifndef HEAP_MONITOR_SAMPLES
+#define HEAP_MONITOR_SAMPLES 3
+#endif
+
+// Restart the microcontroller when the heap is unhealthy and no threshold callback is set
+#ifndef HEAP_MONITOR_RESTART
+#define HEAP_MONITOR_RESTART false
+#endif
+
+// Milliseconds between two WiFi/Ethernet link evaluations when ethernet is enabled, link events are evaluated immediately
+#ifndef LINK_CHECK_INTERVAL
+#define LINK_CHECK_INTERVAL 1000
+#endif
+
+// Score points the other link must gain over the active one before switching, links that are down are replaced immediately
+#ifndef LINK_HYSTERESIS
+#define LINK_HYSTERESIS 15
+#endif
+
+// Milliseconds between two ICMP echoes sent by PingService to its targets in turn, 0 to disable
+#ifndef PING_INTERVAL
+#define PING_INTERVAL 0
+#endif
+
+// Milliseconds to wait for an echo reply (ESP32, ESP8266 uses the core timeout of 1 second)
+#ifndef PING_TIMEOUT
+#define PING_TIMEOUT 1000
+#endif
+
+// Number of probes per target used to compute round trip time and loss statistics
+#ifndef PING_WINDOW
+#define PING_WINDOW 10
+#endif
+
+// Max number of ping targets, the gateway and the MQTT broker are added by default
+#ifndef PING_MAX_TARGETS
+#define PING_MAX_TARGETS 4
+#endif
+
+// Milliseconds between two connection health samples, 0 to disable
+#ifndef HEALTH_INTERVAL
+#define HEALTH_INTERVAL 5000
+#endif
+
+// Health score (1-100) below which the connection is reconnected before it drops, 0 only reports the score
+#ifndef HEALTH_RECONNECT_SCORE
+#define HEALTH_RECONNECT_SCORE 0
+#endif
+
+// Number of consecutive samples below HEALTH_RECONNECT_SCORE before reconnecting
+#ifndef HEALTH_SAMPLES
+#define HEALTH_SAMPLES 3
+#endif
+
+// Minimum milliseconds between two reconnections triggered by the health monitor
+#ifndef HEALTH_ACTION_COOLDOWN
+#define HEALTH_ACTION_COOLDOWN 60000
+#endif
+
+// Gateway round trip time in milliseconds above which the health score is lowered
+#ifndef HEALTH_MAX_RTT
+#define HEALTH_MAX_RTT 200
+#endif
+
+// Max number of WiFi networks, qsid/qpass and the "networks" list of the setup file
+#ifndef WIFI_MAX_NETWORKS
+#define WIFI_MAX_NETWORKS 4
+#endif
+
+// Milliseconds between two checks of the WiFi signal for roaming (e.g. 30000), disabled by default
+#ifndef ROAMING_CHECK_INTERVAL
+#define ROAMING_CHECK_INTERVAL 0
+#endif
+
+// Milliseconds between two polls of a running scan or association
+#ifndef ROAMING_POLL_INTERVAL
+#define ROAMING_POLL_INTERVAL 500
+#endif
+
+// Access points are scanned when the RSSI (dBm) is below this value
+#ifndef ROAMING_RSSI_THRESHOLD
+#define ROAMING_RSSI_THRESHOLD -75
+#endif
+
+// dB a known access point must be stronger than the current one to move to it
+#ifndef ROAMING_RSSI_MARGIN
+#define ROAMING_RSSI_MARGIN 8
+#endif
+
+// Minimum milliseconds between two moves
+#ifndef ROAMING_COOLDOWN
+#define ROAMING_COOLDOWN 60000
+#endif
+
+// Milliseconds to wait for the association with the new access point before giving the reconnection back to the WiFi manager
+#ifndef ROAMING_ASSOCIATION_TIMEOUT
+#define ROAMING_ASSOCIATION_TIMEOUT 10000
+#endif
+
+// Max number of MQTT brokers, mqttIP/mqttPort and the "brokers" list of the setup file
+#ifndef MQTT_MAX_BROKERS
+#define MQTT_MAX_BROKERS 3
+#endif
+
+// Failed connections in a row before moving to the next MQTT broker
+#ifndef MQTT_BROKER_FAILURES
+#define MQTT_BROKER_FAILURES 3
+#endif
+
+// Milliseconds between two probes of the primary MQTT broker while connected to a backup one, 0 to stay on the backup
+#ifndef MQTT_FAILBACK_INTERVAL
+#define MQTT_FAILBACK_INTERVAL 300000
+#endif
+
+// Milliseconds to wait for the TCP connection of the primary MQTT broker probe
+#ifndef MQTT_FAILBACK_PROBE_TIMEOUT
+#define MQTT_FAILBACK_PROBE_TIMEOUT 1000
+#endif
+
+// Milliseconds the address of an MQTT broker hostname is cached
+#ifndef MQTT_DNS_TTL
+#define MQTT_DNS_TTL 600000
+#endif
+
+// Connect to the MQTT broker over TLS, use the TLS port of the broker (usually 8883)
+#ifndef MQTT_TLS
+#define MQTT_TLS false
+#endif
+
+// TLS receive buffer on ESP8266 when the broker supports the max fragment length extension (512, 1024, 2048 or 4096)
+#ifndef MQTT_TLS_RX_BUFFER
+#define MQTT_TLS_RX_BUFFER 1024
+#endif
+
+// TLS transmit buffer on ESP8266, must fit MQTT_MAX_PACKET_SIZE to avoid splitting messages
+#ifndef MQTT_TLS_TX_BUFFER
+#define MQTT_TLS_TX_BUFFER 1024
+#endif
+
+// Seconds to wait for the TLS handshake on ESP32
+#ifndef MQTT_TLS_HANDSHAKE_TIMEOUT
+#define MQTT_TLS_HANDSHAKE_TIMEOUT 10
+#endif
+
+// Firmware update progress is printed every OTA_PROGRESS_STEP percent
+#ifndef OTA_PROGRESS_STEP
+#define OTA_PROGRESS_STEP 10
+#endif
+
+// Accept gzip compressed images in OtaManager::updateFromUrl() on ESP32, needs the inflate of the ROM (miniz)
+#ifndef OTA_GZIP
+#define OTA_GZIP true
+#endif
+
 // Additional param that can be used for general purpose use
 #ifndef ADDITIONAL_PARAM_TEXT
 #define ADDITIONAL_PARAM_TEXT "ADDITIONAL PARAM"
@@ -0,0 +1,122 @@
+/*
+  DeltaPatch.cpp - Delta patch decoder for OTA firmware updates
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "DeltaPatch.h"
+#include <string.h>
+
+static const uint8_t DELTA_PATCH_MAGIC[DELTA_PATCH_MAGIC_SIZE] = {'D', 'O', 'T', 'A'};
+
+static uint32_t readUint32(const uint8_t *data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+bool DeltaPatch::isPatch(const uint8_t *data, size_t length) {
+  return length >= DELTA_PATCH_MAGIC_SIZE && memcmp(data, DELTA_PATCH_MAGIC, DELTA_PATCH_MAGIC_SIZE) == 0;
+}
+
+bool DeltaPatch::parseHeader(const uint8_t *data, DeltaPatchHeader &parsed) {
+  if (!isPatch(data, DELTA_PATCH_HEADER)) return false;
+  parsed.oldSize = readUint32(data + 4);
+  parsed.newSize = readUint32(data + 8);
+  memcpy(parsed.oldMd5, data + 12, sizeof(parsed.oldMd5));
+  memcpy(parsed.newMd5, data + 28, sizeof(parsed.newMd5));
+  return true;
+}
+
+bool DeltaPatch::readByte(uint8_t &byte) {
+  if (inputOffset == inputLength) {
+    inputLength = readPatch(input, sizeof(input));
+    inputOffset = 0;
+    if (inputLength == 0) return false;
+  }
+  byte = input[inputOffset++];
+  return true;
+}
+
+bool DeltaPatch::readVarint(uint32_t &value) {
+  value = 0;
+  uint8_t byte;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (!readByte(byte)) return false;
+    value |= (uint32_t) (byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+// a patch that writes past the new size is corrupted
+bool DeltaPatch::write(uint8_t byte) {
+  if (written + outputLength >= header.newSize) return false;
+  output[outputLength++] = byte;
+  return outputLength < sizeof(output) || flush();
+}
+
+bool DeltaPatch::flush() {
+  if (outputLength == 0) return true;
+  bool ok = writeNew(output, outputLength);
+  written += outputLength;
+  outputLength = 0;
+  return ok;
+}
+
+// count bytes of the old image, plus the next diff bytes of the patch when changed
+bool DeltaPatch::copyOld(uint32_t count, bool changed) {
+  uint8_t old[64];
+  while (count > 0) {
+    size_t size = count < sizeof(old) ? count : sizeof(old);
+    // a seek can move oldPos anywhere, the bounds are checked without sums that could wrap around
+    if (oldPos > header.oldSize || size > header.oldSize - oldPos || !readOld(oldPos, old, size)) return false;
+    oldPos += size;
+    for (size_t i = 0; i < size; i++) {
+      uint8_t diff = 0;
+      if (changed && !readByte(diff)) return false;
+      if (!write(old[i] + diff)) return false;
+    }
+    count -= size;
+  }
+  return true;
+}
+
+bool DeltaPatch::apply(const DeltaPatchHeader &patchHeader) {
+  header = patchHeader;
+  inputOffset = 0;
+  inputLength = 0;
+  outputLength = 0;
+  oldPos = 0;
+  written = 0;
+  bool ok = true;
+  while (ok && written + outputLength < header.newSize) {
+    uint32_t diffLength, extraLength, seek;
+    ok = readVarint(diffLength) && readVarint(extraLength) && readVarint(seek);
+    // changed and unchanged runs of the diff bytes
+    while (ok && diffLength > 0) {
+      uint32_t same, changed;
+      ok = readVarint(same) && readVarint(changed) && same <= diffLength && changed <= diffLength - same
+           && same + changed > 0 && copyOld(same, false) && copyOld(changed, true);
+      diffLength -= same + changed;
+    }
+    for (uint32_t i = 0; ok && i < extraLength; i++) {
+      uint8_t byte;
+      ok = readByte(byte) && write(byte);
+    }
+    oldPos += (int32_t) ((seek >> 1) ^ -(int32_t) (seek & 1));
+    progress(written + outputLength, header.newSize);
+  }
+  return ok && flush() && written == header.newSize;
+}
@@ -0,0 +1,85 @@
+/*
+  DeltaPatch.h - Delta patch decoder for OTA firmware updates
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_DELTA_PATCH_H
+#define _DPSOFTWARE_DELTA_PATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_PATCH_MAGIC_SIZE 4
+#define DELTA_PATCH_HEADER 44
+#define DELTA_PATCH_BUFFER 256
+
+struct DeltaPatchHeader {
+    uint32_t oldSize;
+    uint32_t newSize;
+    uint8_t oldMd5[16];
+    uint8_t newMd5[16];
+};
+
+/*
+  Patch format, little endian, made by tools/delta_ota.py from the bsdiff control blocks:
+  header: "DOTA", old size (4), new size (4), MD5 of the old image (16), MD5 of the new image (16)
+  blocks until new size bytes are written: diff length, extra length, zigzag seek of the old position (varints),
+  diff length bytes added to the old image, sent as varint runs of unchanged bytes and of changed bytes,
+  then extra length bytes copied as they are.
+  The decoder doesn't know where the patch comes from or where the images are stored, a subclass reads
+  the patch, reads the old image and writes the new one.
+*/
+class DeltaPatch {
+
+private:
+    uint8_t input[DELTA_PATCH_BUFFER];
+    size_t inputOffset = 0;
+    size_t inputLength = 0;
+    uint8_t output[DELTA_PATCH_BUFFER];
+    size_t outputLength = 0;
+    uint32_t oldPos = 0;
+    uint32_t written = 0;
+    DeltaPatchHeader header = {};
+
+    bool readByte(uint8_t &byte);
+
+    bool readVarint(uint32_t &value);
+
+    bool write(uint8_t byte);
+
+    bool flush();
+
+    bool copyOld(uint32_t count, bool changed);
+
+protected:
+    virtual size_t readPatch(uint8_t *buffer, size_t size) = 0; // up to size bytes of the patch, 0 at the end
+    virtual bool readOld(uint32_t offset, uint8_t *data, size_t size) = 0; // bytes of the running image
+    virtual bool writeNew(const uint8_t *data, size_t size) = 0; // bytes of the new image, in order
+    virtual void progress(uint32_t, uint32_t) {} // done and total bytes of the new image
+
+public:
+    virtual ~DeltaPatch() = default;
+
+    static bool isPatch(const uint8_t *data, size_t length); // true if data starts with the patch magic
+    static bool parseHeader(const uint8_t *data, DeltaPatchHeader &parsed); // data holds DELTA_PATCH_HEADER bytes
+
+    bool apply(const DeltaPatchHeader &patchHeader); // decode the blocks after the header, true when the new image is complete
+
+    uint32_t getWritten() const { return written; }
+};
+
+#endif
@@ -0,0 +1,162 @@
+/*
+  DisplayManager.cpp - Coalesced and rate limited display transfers
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "DisplayManager.h"
+
+#if (DISPLAY_ENABLED && DISPLAY_PARTIAL_FLUSH)
+#include <Wire.h>
+
+// same limits used by Adafruit_SSD1306
+#if defined(I2C_BUFFER_LENGTH)
+#define DISPLAY_WIRE_MAX min(256, I2C_BUFFER_LENGTH)
+#elif defined(BUFFER_LENGTH)
+#define DISPLAY_WIRE_MAX min(256, BUFFER_LENGTH)
+#else
+#define DISPLAY_WIRE_MAX 32
+#endif
+
+// bus, address and clocks given to the Adafruit_SSD1306 constructor and display.begin(), they are protected members
+class DisplayBus : public Adafruit_SSD1306 {
+
+public:
+    static TwoWire *bus() { return display.*(&DisplayBus::wire); }
+
+    static uint8_t address() { return display.*(&DisplayBus::i2caddr); }
+
+#if ARDUINO >= 157
+    static uint32_t clock() { return display.*(&DisplayBus::wireClk); }
+
+    static uint32_t restoreClock() { return display.*(&DisplayBus::restoreClk); }
+#endif
+};
+
+// what the display is showing
+static uint8_t shadow[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+bool DisplayManager::shadowValid = false;
+#endif
+
+bool DisplayManager::dirty = false;
+unsigned long DisplayManager::lastTransfer = 0;
+DisplayFlushStats DisplayManager::stats = {};
+
+void DisplayManager::markDirty() {
+  stats.requests++;
+  dirty = true;
+}
+
+void DisplayManager::update() {
+  if (dirty && millis() - lastTransfer >= DISPLAY_FRAME_INTERVAL) {
+    transfer();
+  }
+}
+
+void DisplayManager::flush() {
+  if (dirty) {
+    transfer();
+  }
+}
+
+void DisplayManager::invalidate() {
+#if (DISPLAY_ENABLED && DISPLAY_PARTIAL_FLUSH)
+  shadowValid = false;
+#endif
+}
+
+const DisplayFlushStats &DisplayManager::getStats() {
+  return stats;
+}
+
+void DisplayManager::transfer() {
+  dirty = false;
+  lastTransfer = millis();
+#if (DISPLAY_ENABLED && DISPLAY_PARTIAL_FLUSH)
+  if (shadowValid) {
+    transferChanged();
+    return;
+  }
+#endif
+#if (DISPLAY_ENABLED)
+  display.display();
+  stats.transfers++;
+  stats.bytes += SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+#if (DISPLAY_PARTIAL_FLUSH)
+  memcpy(shadow, display.getBuffer(), sizeof(shadow));
+  shadowValid = true;
+#endif
+#endif
+}
+
+#if (DISPLAY_ENABLED && DISPLAY_PARTIAL_FLUSH)
+// send the smallest rectangle of pages and columns that contains every changed byte
+void DisplayManager::transferChanged() {
+  const uint8_t *buffer = display.getBuffer();
+  int16_t firstPage = -1, lastPage = -1, firstColumn = SCREEN_WIDTH, lastColumn = -1;
+  for (int16_t page = 0; page < SCREEN_HEIGHT / 8; page++) {
+    const uint8_t *row = buffer + page * SCREEN_WIDTH;
+    const uint8_t *shadowRow = shadow + page * SCREEN_WIDTH;
+    if (memcmp(row, shadowRow, SCREEN_WIDTH) == 0) continue;
+    if (firstPage < 0) firstPage = page;
+    lastPage = page;
+    int16_t left = 0;
+    while (row[left] == shadowRow[left]) left++;
+    int16_t right = SCREEN_WIDTH - 1;
+    while (row[right] == shadowRow[right]) right--;
+    if (left < firstColumn) firstColumn = left;
+    if (right > lastColumn) lastColumn = right;
+  }
+  if (firstPage < 0) {
+    stats.skipped++;
+    return;
+  }
+  display.ssd1306_command(SSD1306_PAGEADDR);
+  display.ssd1306_command(firstPage);
+  display.ssd1306_command(lastPage);
+  display.ssd1306_command(SSD1306_COLUMNADDR);
+  display.ssd1306_command(firstColumn);
+  display.ssd1306_command(lastColumn);
+  TwoWire *wire = DisplayBus::bus();
+  uint8_t address = DisplayBus::address();
+#if ARDUINO >= 157
+  wire->setClock(DisplayBus::clock());
+#endif
+  wire->beginTransmission(address);
+  wire->write((uint8_t) 0x40);
+  uint16_t bytesOut = 1;
+  for (int16_t page = firstPage; page <= lastPage; page++) {
+    const uint8_t *row = buffer + page * SCREEN_WIDTH;
+    for (int16_t column = firstColumn; column <= lastColumn; column++) {
+      if (bytesOut >= DISPLAY_WIRE_MAX) {
+        wire->endTransmission();
+        wire->beginTransmission(address);
+        wire->write((uint8_t) 0x40);
+        bytesOut = 1;
+      }
+      wire->write(row[column]);
+      bytesOut++;
+    }
+    memcpy(shadow + page * SCREEN_WIDTH + firstColumn, row + firstColumn, lastColumn - firstColumn + 1);
+  }
+  wire->endTransmission();
+#if ARDUINO >= 157
+  wire->setClock(DisplayBus::restoreClock());
+#endif
+  stats.transfers++;
+  stats.bytes += (lastPage - firstPage + 1) * (lastColumn - firstColumn + 1);
+}
+#endif
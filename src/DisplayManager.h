@@ -0,0 +1,65 @@
+/*
+  DisplayManager.h - Coalesced and rate limited display transfers
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_DISPLAY_MANAGER_H
+#define _DPSOFTWARE_DISPLAY_MANAGER_H
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+struct DisplayFlushStats {
+    uint32_t requests; // smartDisplay() calls
+    uint32_t transfers; // framebuffer transfers to the display
+    uint32_t skipped; // transfers avoided because nothing changed
+    uint32_t bytes; // framebuffer bytes sent
+};
+
+/*
+  The framebuffer is marked dirty by smartDisplay() and sent to the display at most once every DISPLAY_FRAME_INTERVAL milliseconds,
+  a frame that is not due yet stays dirty and is sent by the next update() from bootstrapLoop().
+  With DISPLAY_PARTIAL_FLUSH only the rectangle that changed since the last transfer is sent,
+  the framebuffer must then reach the display only through this class, or invalidate() must be called after display.display().
+*/
+class DisplayManager {
+
+private:
+    static bool dirty;
+    static unsigned long lastTransfer;
+    static DisplayFlushStats stats;
+#if (DISPLAY_ENABLED && DISPLAY_PARTIAL_FLUSH)
+    static bool shadowValid;
+
+    static void transferChanged();
+#endif
+
+    static void transfer();
+
+public:
+    static void markDirty(); // the framebuffer changed
+
+    static void update(); // send the framebuffer if it's dirty and the frame interval elapsed
+
+    static void flush(); // send the framebuffer now if it's dirty, before a delay or a blocking call
+
+    static void invalidate(); // the next transfer sends the whole framebuffer
+
+    static const DisplayFlushStats &getStats();
+};
+
+#endif
@@ -19,6 +19,7 @@
 #include "EthManager.h"
 
 #if defined(ARDUINO_ARCH_ESP32)
+#if !defined(ETH_BOARD)
 /**
  * Supported ethernet devices
  */
@@ -27,114 +28,30 @@ const ethernet_config ethernetDevices[] = {
   {
   },
 #if CONFIG_IDF_TARGET_ESP32
-  // QuinLed-ESP32-Ethernet
-  {
-    0,
-    5,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO17_OUT
-  },
-  // QuinLed-Dig-Octa Brainboard-32-8L and LilyGO-T-ETH-POE
-  {
-    0,
-    -1,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO17_OUT
-  },
-  // WT32-EHT01
-  // These pins works well: IO2, IO4, IO12, IO14, IO15
-  // These not: IO35, IO36, IO39
-  {
-    1,
-    16,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO0_IN
-  },
-  // ESP32-ETHERNET-KIT-VE
-  {
-    0,
-    5,
-    23,
-    18,
-    ETH_PHY_IP101,
-    ETH_CLOCK_GPIO0_IN
-  },
-  // ESP32-POE
-  {
-    0,
-    12,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO17_OUT
-  },
-  // WESP32
-  {
-    0,
-    -1,
-    16,
-    17,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO0_IN
-  },
-  // LilyGO-T-POE-Pro
-  {
-    0,
-    5,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO0_OUT
-  },
-  // ESP32-POE-WROVER
-  {
-    0,
-    12,
-    23,
-    18,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO0_OUT
-  },
-  // Gledopto with ethernet
-  {
-    1,
-    5,
-    23,
-    33,
-    ETH_PHY_LAN8720,
-    ETH_CLOCK_GPIO0_IN
-  }
+  EthBoard<1>::config,
+  EthBoard<2>::config,
+  EthBoard<3>::config,
+  EthBoard<4>::config,
+  EthBoard<5>::config,
+  EthBoard<6>::config,
+  EthBoard<7>::config,
+  EthBoard<8>::config,
+  EthBoard<9>::config
 #endif
 };
 
 const ethernet_confi_spi ethernetDevicesSpi[] = {
-  // T-ETH ELite ESP32-S3
-  {
-    47,
-    21,
-    48,
-    45
-  },
-  // T-ETH Lite ESP32-S3
-  {
-    11,
-    12,
-    10,
-    9
-  }
+  EthBoard<spiStartIdx + 1>::config,
+  EthBoard<spiStartIdx + 2>::config
 };
+#endif
 
 /**
  * Init SPI ethernet
  * @param deviceNumber to use
  */
-void EthManager::initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs) {
+void EthManager::initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs, int8_t irq, int8_t rst) {
+#if !defined(ETH_BOARD)
   if (deviceNumber > spiStartIdx) {
     deviceNumber = deviceNumber - spiStartIdx - 1;
     cs = ethernetDevicesSpi[deviceNumber].cs_pin;
@@ -142,8 +59,9 @@ void EthManager::initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso,
     miso = ethernetDevicesSpi[deviceNumber].miso_pin;
     mosi = ethernetDevicesSpi[deviceNumber].mosi_pin;
   }
+#endif
   SPI.begin(sclk, miso, mosi);
-  ETH.begin(ETH_PHY_W5500, -1, cs, -1, -1, SPI);
+  ETH.begin(ETH_PHY_W5500, -1, cs, irq, rst, SPI);
 }
 
 /**
@@ -151,7 +69,7 @@ void EthManager::initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso,
  * @param deviceNumber to use
  */
 void EthManager::initRmiiEthernet(int8_t deviceNumber) {
-#if CONFIG_IDF_TARGET_ESP32
+#if CONFIG_IDF_TARGET_ESP32 && !defined(ETH_BOARD)
   ETH.begin(
     ethernetDevices[deviceNumber].type,
     ethernetDevices[deviceNumber].address,
@@ -167,15 +85,17 @@ void EthManager::initRmiiEthernet(int8_t deviceNumber) {
  * Connect to ethernet
  * @param deviceNumber to use
  */
-void EthManager::connectToEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs) {
-#if CONFIG_IDF_TARGET_ESP32
+void EthManager::connectToEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs, int8_t irq, int8_t rst) {
+#if defined(ETH_BOARD)
+  connectToBoard<ETH_BOARD>(mosi, miso, sclk, cs, irq, rst);
+#elif CONFIG_IDF_TARGET_ESP32
   if (deviceNumber < spiStartIdx) {
     initRmiiEthernet(deviceNumber);
   } else {
-    initSpiEthernet(deviceNumber, mosi, miso, sclk, cs);
+    initSpiEthernet(deviceNumber, mosi, miso, sclk, cs, irq, rst);
   }
 #else
-  initSpiEthernet(deviceNumber, mosi, miso, sclk, cs);
+  initSpiEthernet(deviceNumber, mosi, miso, sclk, cs, irq, rst);
 #endif
 }
 
@@ -184,6 +104,9 @@ void EthManager::connectToEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso
  * @param deviceNumber to deallocate
  */
 void EthManager::deallocateEthernetPins(int8_t deviceNumber) {
+#if defined(ETH_BOARD)
+  deallocateBoardPins<ETH_BOARD>();
+#else
   if (deviceNumber < spiStartIdx) {
     gpio_reset_pin((gpio_num_t) ethernetDevices[deviceNumber].address);
     gpio_reset_pin((gpio_num_t) ethernetDevices[deviceNumber].power);
@@ -194,6 +117,7 @@ void EthManager::deallocateEthernetPins(int8_t deviceNumber) {
 #endif
   }
   delay(1);
+#endif
 }
 
 #endif
@@ -41,7 +41,9 @@ typedef struct EthConfig {
 #endif
 } ethernet_config;
 
+#if !defined(ETH_BOARD)
 extern const ethernet_config ethernetDevices[];
+#endif
 
 typedef struct EthConfigW5500 {
   int miso_pin;
@@ -50,21 +52,114 @@ typedef struct EthConfigW5500 {
   int cs_pin;
 } ethernet_confi_spi;
 
+#if !defined(ETH_BOARD)
 extern const ethernet_confi_spi ethernetDevicesSpi[];
+#endif
 
 const uint8_t spiStartIdx = 100;
 
+/*
+  Board profiles, EthBoard<N> is the board with device number N (ethd).
+  Build with -D ETH_BOARD=EthBoard<N> to compile only that board, the device tables are not linked
+  and a device number without a profile doesn't compile. A custom board is a type, example:
+    struct MyW5500Board : EthW5500Board<13, 11, 12, 10> {};
+  built with -D ETH_BOARD=MyW5500Board. Without ETH_BOARD the board is selected at runtime from the tables.
+*/
+enum EthBus {
+  EthBus_Rmii,
+  EthBus_Spi,
+  EthBus_SpiPins // W5500 with the pins read from the setup file
+};
+
+template<int DeviceNumber>
+struct EthBoard;
+
+#if CONFIG_IDF_TARGET_ESP32
+template<uint8_t Address, int Power, int Mdc, int Mdio, eth_phy_type_t Type, eth_clock_mode_t ClkMode>
+struct EthRmiiBoard {
+  static constexpr EthBus bus = EthBus_Rmii;
+  static constexpr ethernet_config config = {Address, Power, Mdc, Mdio, Type, ClkMode};
+};
+#endif
+
+template<int Miso, int Mosi, int Sclk, int Cs>
+struct EthW5500Board {
+  static constexpr EthBus bus = EthBus_Spi;
+  static constexpr ethernet_confi_spi config = {Miso, Mosi, Sclk, Cs};
+};
+
+#if CONFIG_IDF_TARGET_ESP32
+// QuinLed-ESP32-Ethernet
+template<> struct EthBoard<1> : EthRmiiBoard<0, 5, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO17_OUT> {};
+// QuinLed-Dig-Octa Brainboard-32-8L and LilyGO-T-ETH-POE
+template<> struct EthBoard<2> : EthRmiiBoard<0, -1, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO17_OUT> {};
+// WT32-EHT01
+// These pins works well: IO2, IO4, IO12, IO14, IO15
+// These not: IO35, IO36, IO39
+template<> struct EthBoard<3> : EthRmiiBoard<1, 16, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO0_IN> {};
+// ESP32-ETHERNET-KIT-VE
+template<> struct EthBoard<4> : EthRmiiBoard<0, 5, 23, 18, ETH_PHY_IP101, ETH_CLOCK_GPIO0_IN> {};
+// ESP32-POE
+template<> struct EthBoard<5> : EthRmiiBoard<0, 12, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO17_OUT> {};
+// WESP32
+template<> struct EthBoard<6> : EthRmiiBoard<0, -1, 16, 17, ETH_PHY_LAN8720, ETH_CLOCK_GPIO0_IN> {};
+// LilyGO-T-POE-Pro
+template<> struct EthBoard<7> : EthRmiiBoard<0, 5, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO0_OUT> {};
+// ESP32-POE-WROVER
+template<> struct EthBoard<8> : EthRmiiBoard<0, 12, 23, 18, ETH_PHY_LAN8720, ETH_CLOCK_GPIO0_OUT> {};
+// Gledopto with ethernet
+template<> struct EthBoard<9> : EthRmiiBoard<1, 5, 23, 33, ETH_PHY_LAN8720, ETH_CLOCK_GPIO0_IN> {};
+#endif
+// W5500 with custom pins
+template<> struct EthBoard<spiStartIdx> {
+  static constexpr EthBus bus = EthBus_SpiPins;
+};
+// T-ETH ELite ESP32-S3
+template<> struct EthBoard<spiStartIdx + 1> : EthW5500Board<47, 21, 48, 45> {};
+// T-ETH Lite ESP32-S3
+template<> struct EthBoard<spiStartIdx + 2> : EthW5500Board<11, 12, 10, 9> {};
+
 class EthManager {
 public:
   static void connectToSpi(int8_t &deviceNumber);
 
-  static void initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs);
+  static void initSpiEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs, int8_t irq = -1, int8_t rst = -1);
 
   static void initRmiiEthernet(int8_t deviceNumber);
 
-  static void connectToEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs);
+  static void connectToEthernet(int8_t deviceNumber, int8_t mosi, int8_t miso, int8_t sclk, int8_t cs, int8_t irq = -1, int8_t rst = -1);
 
   static void deallocateEthernetPins(int8_t deviceNumber);
+
+  template<typename Board>
+  static void connectToBoard(int8_t mosi, int8_t miso, int8_t sclk, int8_t cs, int8_t irq = -1, int8_t rst = -1) {
+    if constexpr (Board::bus == EthBus_Spi) {
+      SPI.begin(Board::config.sclk_sck_pin, Board::config.miso_pin, Board::config.mosi_pin);
+      ETH.begin(ETH_PHY_W5500, -1, Board::config.cs_pin, irq, rst, SPI);
+    } else if constexpr (Board::bus == EthBus_SpiPins) {
+      SPI.begin(sclk, miso, mosi);
+      ETH.begin(ETH_PHY_W5500, -1, cs, irq, rst, SPI);
+    } else {
+#if CONFIG_IDF_TARGET_ESP32
+      ETH.begin(Board::config.type, Board::config.address, Board::config.mdc, Board::config.mdio,
+                Board::config.power, Board::config.clk_mode);
+#endif
+    }
+  }
+
+  template<typename Board>
+  static void deallocateBoardPins() {
+    if constexpr (Board::bus == EthBus_Rmii) {
+      gpio_reset_pin((gpio_num_t) Board::config.address);
+      gpio_reset_pin((gpio_num_t) Board::config.power);
+      gpio_reset_pin((gpio_num_t) Board::config.mdc);
+      gpio_reset_pin((gpio_num_t) Board::config.mdio);
+#if CONFIG_IDF_TARGET_ESP32
+      gpio_reset_pin((gpio_num_t) Board::config.clk_mode);
+#endif
+    }
+    delay(1);
+  }
 };
 
 #endif
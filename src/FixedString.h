@@ -0,0 +1,180 @@
+/*
+  FixedString.h - Statically allocated string with a String like interface
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_FIXED_STRING_H
+#define _DPSOFTWARE_FIXED_STRING_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <type_traits>
+
+/*
+  N chars buffer (terminator included) that never touches the heap, longer values are truncated,
+  assign() and concat() return false when they truncate.
+  It offers the String methods used on config values: assignment, +=, comparison, substring(), indexOf(),
+  startsWith(), toUpperCase(), trim(), toInt() and so on. Methods that build a new string return a String,
+  other String methods are available on a copy: String(deviceName).
+*/
+template<size_t N>
+class FixedString : public Printable {
+
+private:
+    char buffer[N] = {};
+
+public:
+    FixedString() = default;
+
+    FixedString(const char *value) { assign(value); }
+
+    bool assign(const char *value) {
+        if (value == nullptr) value = "";
+        strncpy(buffer, value, N - 1);
+        buffer[N - 1] = '\0';
+        return strlen(value) < N;
+    }
+
+    bool concat(const char *value) {
+        if (value == nullptr) return true;
+        size_t used = length();
+        strncpy(buffer + used, value, N - 1 - used);
+        buffer[N - 1] = '\0';
+        return used + strlen(value) < N;
+    }
+
+    bool concat(char value) {
+        char text[2] = {value, '\0'};
+        return concat(text);
+    }
+
+    FixedString &operator=(const char *value) { assign(value); return *this; }
+
+    FixedString &operator=(const String &value) { assign(value.c_str()); return *this; }
+
+    FixedString &operator=(const __FlashStringHelper *value) {
+        strncpy_P(buffer, (PGM_P) value, N - 1);
+        buffer[N - 1] = '\0';
+        return *this;
+    }
+
+    template<size_t M>
+    FixedString &operator=(const FixedString<M> &value) { assign(value.c_str()); return *this; }
+
+    FixedString &operator+=(const char *value) { concat(value); return *this; }
+
+    FixedString &operator+=(const String &value) { concat(value.c_str()); return *this; }
+
+    FixedString &operator+=(char value) { concat(value); return *this; }
+
+    const char *c_str() const { return buffer; }
+
+    size_t length() const { return strlen(buffer); }
+
+    static constexpr size_t capacity() { return N - 1; }
+
+    bool isEmpty() const { return buffer[0] == '\0'; }
+
+    long toInt() const { return atol(buffer); }
+
+    float toFloat() const { return (float) atof(buffer); }
+
+    char charAt(size_t index) const { return (*this)[index]; }
+
+    int indexOf(char value, size_t from = 0) const {
+        const char *found = from < length() ? strchr(buffer + from, value) : nullptr;
+        return found != nullptr ? (int) (found - buffer) : -1;
+    }
+
+    int indexOf(const char *value, size_t from = 0) const {
+        const char *found = from <= length() ? strstr(buffer + from, value) : nullptr;
+        return found != nullptr ? (int) (found - buffer) : -1;
+    }
+
+    int lastIndexOf(char value) const {
+        const char *found = strrchr(buffer, value);
+        return found != nullptr ? (int) (found - buffer) : -1;
+    }
+
+    bool startsWith(const char *value) const { return strncmp(buffer, value, strlen(value)) == 0; }
+
+    bool endsWith(const char *value) const {
+        size_t used = length();
+        size_t size = strlen(value);
+        return size <= used && strcmp(buffer + used - size, value) == 0;
+    }
+
+    String substring(size_t from) const { return String(buffer).substring(from); }
+
+    String substring(size_t from, size_t to) const { return String(buffer).substring(from, to); }
+
+    void toUpperCase() { for (char *c = buffer; *c; c++) *c = (char) toupper(*c); }
+
+    void toLowerCase() { for (char *c = buffer; *c; c++) *c = (char) tolower(*c); }
+
+    void trim() {
+        size_t start = 0;
+        size_t end = length();
+        while (start < end && isspace((unsigned char) buffer[start])) start++;
+        while (end > start && isspace((unsigned char) buffer[end - 1])) end--;
+        memmove(buffer, buffer + start, end - start);
+        buffer[end - start] = '\0';
+    }
+
+    bool equals(const char *value) const { return strcmp(buffer, value) == 0; }
+
+    bool operator==(const char *value) const { return equals(value); }
+
+    bool operator!=(const char *value) const { return !equals(value); }
+
+    bool operator==(const String &value) const { return equals(value.c_str()); }
+
+    bool operator!=(const String &value) const { return !equals(value.c_str()); }
+
+    char operator[](size_t index) const { return index < N ? buffer[index] : '\0'; }
+
+    operator String() const { return String(buffer); }
+
+    size_t printTo(Print &p) const override { return p.print(buffer); }
+};
+
+// any String on the left, StringSumHelper included, so that "a" + String(b) + deviceName is not ambiguous
+template<typename S, size_t N, typename = typename std::enable_if<std::is_base_of<String, S>::value>::type>
+String operator+(const S &lhs, const FixedString<N> &rhs) { String result(lhs); result += rhs.c_str(); return result; }
+
+template<size_t N>
+String operator+(const FixedString<N> &lhs, const String &rhs) { String result(lhs.c_str()); result += rhs; return result; }
+
+template<size_t N>
+String operator+(const char *lhs, const FixedString<N> &rhs) { String result(lhs); result += rhs.c_str(); return result; }
+
+template<size_t N>
+String operator+(const FixedString<N> &lhs, const char *rhs) { String result(lhs.c_str()); result += rhs; return result; }
+
+// doc["deviceName"] = deviceName; and deviceName = doc["deviceName"]; work as with String
+namespace ArduinoJson {
+template<size_t N>
+struct Converter<FixedString<N>> {
+    static bool toJson(const FixedString<N> &src, JsonVariant dst) { return dst.set(src.c_str()); }
+
+    static FixedString<N> fromJson(JsonVariantConst src) { return FixedString<N>(src.as<const char *>()); }
+
+    static bool checkJson(JsonVariantConst src) { return src.is<const char *>(); }
+};
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+  HealthMonitor.cpp - Connection health score and early reconnection
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "HealthMonitor.h"
+#include "Helpers.h"
+#include "Logger.h"
+#include "PingService.h"
+#include "QueueManager.h"
+#include "RoamingManager.h"
+#include "TaskScheduler.h"
+
+HealthStats HealthMonitor::stats = {};
+uint32_t HealthMonitor::lastPublishFailures = 0;
+uint8_t HealthMonitor::lowSamples = 0;
+int16_t HealthMonitor::smoothedQuality = 0;
+unsigned long HealthMonitor::lastAction = 0;
+void (*HealthMonitor::actionCallback)(const HealthStats &stats) = nullptr;
+
+void HealthMonitor::begin() {
+  stats = {};
+  stats.wifiQuality = -1;
+  lowSamples = 0;
+  lastPublishFailures = QueueManager::getPublishFailures();
+  TaskScheduler::every(HEALTH_INTERVAL, sample);
+}
+
+void HealthMonitor::sample() {
+  int16_t quality = WifiManager::getQuality();
+  if (quality < 0) {
+    stats.wifiQuality = -1;
+    stats.wifiTrend = 0;
+  } else if (stats.wifiQuality < 0) {
+    smoothedQuality = quality * 16;
+    stats.wifiQuality = quality;
+    stats.wifiTrend = 0;
+  } else {
+    // moving average with 1/4 weight to the new sample, in 1/16 % so that a slow decline is not truncated away
+    int16_t smoothed = smoothedQuality + (quality * 16 - smoothedQuality) / 4;
+    stats.wifiTrend = smoothed - smoothedQuality;
+    smoothedQuality = smoothed;
+    stats.wifiQuality = (smoothed + 8) / 16;
+  }
+#if (PING_INTERVAL > 0)
+  PingStats ping = PingService::getStats(0);
+  stats.pingLoss = ping.loss;
+  stats.pingRtt = ping.avg;
+#endif
+  uint32_t publishFailures = QueueManager::getPublishFailures();
+  stats.publishFailures = publishFailures - lastPublishFailures;
+  lastPublishFailures = publishFailures;
+
+  bool wifiUp = stats.wifiQuality >= 0;
+  if (!wifiUp && !ethConnected) {
+    stats.score = 0;
+    lowSamples = 0;
+    return;
+  }
+  int16_t score = 100;
+  if (wifiUp && !ethConnected) {
+    // below 40% quality the link starts losing frames, a falling quality is penalized before it gets there
+    if (stats.wifiQuality < 40) score -= (40 - stats.wifiQuality) * 2;
+    // 4 points for every % lost per sample
+    if (stats.wifiTrend < 0) score += stats.wifiTrend / 4;
+  }
+  score -= stats.pingLoss;
+  if (stats.pingRtt > HEALTH_MAX_RTT) score -= 20;
+  // 4 failures already take the whole score, more would wrap around in the 16 bit score
+  score -= (stats.publishFailures < 4 ? stats.publishFailures : 4) * 25;
+  stats.score = score > 1 ? score : 1;
+  checkScore();
+}
+
+void HealthMonitor::checkScore() {
+#if (HEALTH_RECONNECT_SCORE > 0)
+  if (stats.score >= HEALTH_RECONNECT_SCORE) {
+    lowSamples = 0;
+    return;
+  }
+  if (lowSamples < HEALTH_SAMPLES) lowSamples++;
+  if (lowSamples < HEALTH_SAMPLES) return;
+  if (stats.actions > 0 && millis() - lastAction < HEALTH_ACTION_COOLDOWN) return;
+  lowSamples = 0;
+  lastAction = millis();
+  stats.actions++;
+  LOG_W("HEALTH", "Link degrading, score: %u, WiFi: %d%% (%d/16 per sample), ping loss: %u%%, rtt: %u ms, write failures: %lu",
+        stats.score, stats.wifiQuality, stats.wifiTrend, stats.pingLoss, stats.pingRtt, (unsigned long) stats.publishFailures);
+  // the network task owns WiFi when it is active
+  QueueManager::runOnNetworkTask(runAction);
+#endif
+}
+
+void HealthMonitor::runAction() {
+  if (actionCallback != nullptr) {
+    actionCallback(stats);
+  } else if (!ethConnected && !RoamingManager::requestScan()) {
+    // without roaming or while a scan is running
+    WiFi.reconnect();
+  }
+}
+
+const HealthStats &HealthMonitor::getStats() {
+  return stats;
+}
+
+void HealthMonitor::setActionCallback(void (*callback)(const HealthStats &stats)) {
+  actionCallback = callback;
+}
+
+void HealthMonitor::addTo(JsonObject object) {
+  object["health"] = stats.score;
+}
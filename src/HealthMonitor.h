@@ -0,0 +1,70 @@
+/*
+  HealthMonitor.h - Connection health score and early reconnection
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_HEALTH_MONITOR_H
+#define _DPSOFTWARE_HEALTH_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+
+struct HealthStats {
+    uint8_t score; // 0 link down, 100 healthy
+    int16_t wifiQuality; // smoothed WiFi quality, -1 when WiFi is not connected
+    int16_t wifiTrend; // change of the smoothed quality per sample, in 1/16 %
+    uint8_t pingLoss; // gateway loss percentage, when PingService is enabled
+    uint16_t pingRtt; // gateway average round trip time in milliseconds
+    uint32_t publishFailures; // MQTT messages that couldn't be written in the last sample
+    uint32_t actions; // reconnections triggered by the monitor
+};
+
+/*
+  Every HEALTH_INTERVAL milliseconds combines the WiFi quality and its trend, the gateway ping loss and round trip time
+  and the MQTT write failures into a score. When the score stays below HEALTH_RECONNECT_SCORE for HEALTH_SAMPLES samples
+  the action callback is called, by default it looks for a stronger access point (RoamingManager) or reconnects WiFi,
+  while the link still works, instead of waiting for it to drop.
+  Actions are at least HEALTH_ACTION_COOLDOWN milliseconds apart and run in the network task when NETWORK_TASK_ACTIVE.
+*/
+class HealthMonitor {
+
+private:
+    static HealthStats stats;
+    static uint32_t lastPublishFailures;
+    static uint8_t lowSamples;
+    static int16_t smoothedQuality; // WiFi quality x16
+    static unsigned long lastAction;
+    static void (*actionCallback)(const HealthStats &stats);
+
+    static void checkScore();
+
+    static void runAction(); // the callback or the default reconnection
+
+public:
+    static void begin();
+
+    static void sample(); // read the link now, called by the scheduler
+
+    static const HealthStats &getStats();
+
+    static void setActionCallback(void (*callback)(const HealthStats &stats)); // replace the default reconnection
+
+    static void addTo(JsonObject object); // health fields for the state message
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*
+  HeapMonitor.cpp - Heap health and fragmentation telemetry
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "HeapMonitor.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
+#include "Helpers.h"
+#include "Logger.h"
+#include "TaskScheduler.h"
+
+HeapStats HeapMonitor::stats = {};
+uint32_t HeapMonitor::lastFreeHeap = 0;
+uint8_t HeapMonitor::unhealthySamples = 0;
+bool HeapMonitor::thresholdNotified = false;
+void (*HeapMonitor::thresholdCallback)(const HeapStats &stats) = nullptr;
+
+void HeapMonitor::begin() {
+  stats = {};
+  stats.healthy = true;
+  lastFreeHeap = 0;
+  sample();
+#if (HEAP_MONITOR_INTERVAL > 0)
+  TaskScheduler::every(HEAP_MONITOR_INTERVAL, sample);
+#endif
+}
+
+void HeapMonitor::sample() {
+  uint32_t freeHeap;
+  uint32_t maxBlock;
+#if defined(ESP8266)
+  uint8_t fragmentation;
+  // a single call, free heap and largest block are read under the same lock
+  ESP.getHeapStats(&freeHeap, &maxBlock, &fragmentation);
+#elif defined(ARDUINO_ARCH_ESP32)
+  freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  maxBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  uint8_t fragmentation = freeHeap > 0 ? 100 - (uint8_t) ((uint64_t) maxBlock * 100 / freeHeap) : 0;
+#endif
+  stats.freeHeap = freeHeap;
+  stats.maxBlock = maxBlock;
+  stats.fragmentation = fragmentation;
+#if defined(ARDUINO_ARCH_ESP32)
+  // the IDF tracks the low water mark on every allocation
+  stats.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+#else
+  if (stats.samples == 0 || freeHeap < stats.minFreeHeap) stats.minFreeHeap = freeHeap;
+#endif
+  if (stats.samples == 0 || maxBlock < stats.minMaxBlock) stats.minMaxBlock = maxBlock;
+#if (HEAP_MONITOR_INTERVAL > 0)
+  if (stats.samples > 0) {
+    // exponential moving average of the change per hour, 1/8 weight to the new sample
+    int32_t perHour = ((int32_t) freeHeap - (int32_t) lastFreeHeap) * (int32_t) (3600000UL / HEAP_MONITOR_INTERVAL);
+    stats.trend = stats.samples == 1 ? perHour : stats.trend + (perHour - stats.trend) / 8;
+  }
+#endif
+  lastFreeHeap = freeHeap;
+  stats.samples++;
+  checkThresholds();
+}
+
+void HeapMonitor::checkThresholds() {
+  bool healthy = true;
+#if (HEAP_MONITOR_MIN_BLOCK > 0)
+  if (stats.maxBlock < HEAP_MONITOR_MIN_BLOCK) healthy = false;
+#endif
+#if (HEAP_MONITOR_MAX_FRAGMENTATION > 0)
+  if (stats.fragmentation > HEAP_MONITOR_MAX_FRAGMENTATION) healthy = false;
+#endif
+  if (healthy) {
+    unhealthySamples = 0;
+    thresholdNotified = false;
+    stats.healthy = true;
+    return;
+  }
+  if (unhealthySamples < HEAP_MONITOR_SAMPLES) unhealthySamples++;
+  if (unhealthySamples < HEAP_MONITOR_SAMPLES || thresholdNotified) return;
+  stats.healthy = false;
+  thresholdNotified = true;
+  LOG_W("HEAP", "Heap unhealthy, free: %lu, max block: %lu, fragmentation: %u%%",
+        (unsigned long) stats.freeHeap, (unsigned long) stats.maxBlock, stats.fragmentation);
+  if (thresholdCallback != nullptr) {
+    thresholdCallback(stats);
+  } else if (HEAP_MONITOR_RESTART) {
+    Helpers::safeRestart();
+  }
+}
+
+const HeapStats &HeapMonitor::getStats() {
+  return stats;
+}
+
+void HeapMonitor::setThresholdCallback(void (*callback)(const HeapStats &stats)) {
+  thresholdCallback = callback;
+}
+
+void HeapMonitor::addTo(JsonObject object) {
+#if (HEAP_MONITOR_INTERVAL == 0)
+  sample();
+#endif
+  object["heap"] = stats.freeHeap;
+  object["heapMaxBlock"] = stats.maxBlock;
+  object["heapFrag"] = stats.fragmentation;
+  object["heapMin"] = stats.minFreeHeap;
+  object["heapTrend"] = stats.trend;
+}
@@ -0,0 +1,67 @@
+/*
+  HeapMonitor.h - Heap health and fragmentation telemetry
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_HEAP_MONITOR_H
+#define _DPSOFTWARE_HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+
+struct HeapStats {
+    uint32_t freeHeap; // bytes
+    uint32_t maxBlock; // largest allocatable block in bytes
+    uint8_t fragmentation; // percentage, 0 when the free heap is a single block
+    uint32_t minFreeHeap; // low water mark since boot
+    uint32_t minMaxBlock; // smallest largest block since boot
+    int32_t trend; // free heap change in bytes per hour, smoothed
+    uint32_t samples;
+    bool healthy;
+};
+
+/*
+  Samples the heap every HEAP_MONITOR_INTERVAL milliseconds from the task scheduler.
+  When the largest block or the fragmentation cross their threshold for HEAP_MONITOR_SAMPLES samples in a row,
+  the threshold callback is called once, it is armed again when the heap recovers.
+  Without a callback and with HEAP_MONITOR_RESTART a controlled restart is requested, before an allocation fails.
+*/
+class HeapMonitor {
+
+private:
+    static HeapStats stats;
+    static uint32_t lastFreeHeap;
+    static uint8_t unhealthySamples;
+    static bool thresholdNotified;
+    static void (*thresholdCallback)(const HeapStats &stats);
+
+    static void checkThresholds();
+
+public:
+    static void begin();
+
+    static void sample(); // read the heap now, called by the scheduler
+
+    static const HeapStats &getStats();
+
+    static void setThresholdCallback(void (*callback)(const HeapStats &stats));
+
+    static void addTo(JsonObject object); // heap fields for the state message
+};
+
+#endif
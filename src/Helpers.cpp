@@ -18,24 +18,27 @@
 */
 
 #include "Helpers.h"
+#include "Logger.h"
+#include "DisplayManager.h"
 
 unsigned long currentMillisMainLoop = 0;
 
 bool isConfigFileOk = false;
-String lastMQTTConnection = "OFF";
-String lastWIFiConnection = "OFF";
-String lastBoot = " ";
+BootstrapConfig bootstrapConfig;
+FixedString<33> &lastMQTTConnection = bootstrapConfig.lastMQTTConnection;
+FixedString<33> &lastWIFiConnection = bootstrapConfig.lastWIFiConnection;
+FixedString<33> &lastBoot = bootstrapConfig.lastBoot;
 
 bool screenSaverTriggered = false;
 
 bool lastPageScrollTriggered = false;
 int yoffset = 150;
-String haVersion = "";
-String firmwareVersion = "";
+FixedString<16> &haVersion = bootstrapConfig.haVersion;
+FixedString<16> &firmwareVersion = bootstrapConfig.firmwareVersion;
 String IP = "";
-String MAC = "";
-String deviceName = "XXX";
-String microcontrollerIP = "XXX";
+FixedString<18> &MAC = bootstrapConfig.MAC;
+FixedString<33> &deviceName = bootstrapConfig.deviceName;
+FixedString<16> &microcontrollerIP = bootstrapConfig.microcontrollerIP;
 IPAddress currentWiFiIp;
 bool dhcpInUse = true;
 #if defined(ARDUINO_ARCH_ESP32)
@@ -44,26 +47,26 @@ int8_t mosi = 0;
 int8_t miso = 0;
 int8_t sclk = 0;
 int8_t cs = 0;
-int8_t interrupt = 0;
-int8_t rst = 0;
+int8_t interrupt = -1;
+int8_t rst = -1;
 #else
 int8_t ethd = -1;
 #endif
-String qsid = "XXX";
-String qpass = "XXX";
-String OTApass = "XXX";
-String mqttIP = "XXX";
-String mqttPort = "XXX";
-String mqttuser = "XXX";
-String mqttpass = "XXX";
-String mqttWillTopic = "0";
-String mqttWillPayload = "0";
+FixedString<33> &qsid = bootstrapConfig.qsid;
+FixedString<65> &qpass = bootstrapConfig.qpass;
+FixedString<65> &OTApass = bootstrapConfig.OTApass;
+FixedString<254> &mqttIP = bootstrapConfig.mqttIP;
+FixedString<6> &mqttPort = bootstrapConfig.mqttPort;
+FixedString<65> &mqttuser = bootstrapConfig.mqttuser;
+FixedString<65> &mqttpass = bootstrapConfig.mqttpass;
+FixedString<128> &mqttWillTopic = bootstrapConfig.mqttWillTopic;
+FixedString<128> &mqttWillPayload = bootstrapConfig.mqttWillPayload;
 int mqttWillQOS = 1;
 bool mqttWillRetain = false;
 bool mqttCleanSession = true;
 bool blockingMqtt = true;
 bool mqttConnected = false;
-String additionalParam = "XXX";
+FixedString<65> &additionalParam = bootstrapConfig.additionalParam;
 bool ethConnected = false;
 bool restartRequested = false;
 unsigned long restartAt = 0;
@@ -74,9 +77,9 @@ bool ledTriggered = false;
 int blinkCounter = 0;
 const int blinkTimes = 6;
 
-String timedate = "OFF";
-[[maybe_unused]] String date = "OFF";
-[[maybe_unused]] String currentime = "OFF";
+FixedString<33> &timedate = bootstrapConfig.timedate;
+[[maybe_unused]] FixedString<11> &date = bootstrapConfig.date;
+[[maybe_unused]] FixedString<6> &currentime = bootstrapConfig.currentime;
 String ERROR = "ERROR";
 
 int wifiReconnectAttemp = 0;
@@ -87,47 +90,19 @@ byte apState;
 bool temporaryDisableImprove = false;
 bool improvePacketReceived = false;
 
-void Helpers::smartPrint(String msg) {
-#if (DISPLAY_ENABLED)
-  display.print(msg);
-#else
-  Serial.print(msg);
-#endif
-}
-
-void Helpers::smartPrintln(String msg) {
-#if (DISPLAY_ENABLED)
-  display.println(msg);
-#else
-  Serial.println(msg);
-#endif
-}
-
-void Helpers::smartPrint(int msg) {
-#if (DISPLAY_ENABLED)
-  display.print(msg);
-#else
-  Serial.print(msg);
-#endif
-}
-
-void Helpers::smartPrintln(int msg) {
-#if (DISPLAY_ENABLED)
-  display.println(msg);
-#else
-  Serial.println(msg);
-#endif
-}
-
+// the transfer is coalesced with the other requests of the same frame
 void Helpers::smartDisplay() {
 #if (DISPLAY_ENABLED)
-  display.display();
+  DisplayManager::markDirty();
+  DisplayManager::update();
 #endif
 }
 
+// the frame must be on the display while waiting
 void Helpers::smartDisplay(int delayTime) {
 #if (DISPLAY_ENABLED)
-  display.display();
+  DisplayManager::markDirty();
+  DisplayManager::flush();
   delay(delayTime);
 #endif
 }
@@ -157,8 +132,15 @@ String Helpers::getValue(String data, char separator, int index) {
 // Set date and time based on a timestamp
 void Helpers::setDateTime(String timeConst) {
   timedate = timeConst;
-  date = timedate.substring(8, 10) + "/" + timedate.substring(5, 7) + "/" + timedate.substring(0, 4);
-  currentime = timedate.substring(11, 16);
+  // dd/mm/yyyy and hh:mm from an ISO 8601 timestamp
+  const char *ts = timedate.c_str();
+  if (timedate.length() >= 16) {
+    char buffer[11];
+    snprintf(buffer, sizeof(buffer), "%.2s/%.2s/%.4s", ts + 8, ts + 5, ts);
+    date = buffer;
+    snprintf(buffer, sizeof(buffer), "%.5s", ts + 11);
+    currentime = buffer;
+  }
 }
 
 // Return ON OFF value
@@ -189,6 +171,7 @@ long Helpers::versionNumberToNumber(const String &latestReleaseStr) {
 
 void Helpers::safeRestartGuard() {
   if (restartRequested && currentMillisMainLoop - restartAt > DELAY_1000) {
+    logger.flushBlocking();
 #if defined(ARDUINO_ARCH_ESP32)
     ESP.restart();
 #elif defined(ESP8266)
@@ -22,24 +22,70 @@
 
 #include <ArduinoJson.h>
 #include "Configuration.h"
+#include "FixedString.h"
+#include "Logger.h"
 
 extern unsigned long currentMillisMainLoop;
 
 extern bool isConfigFileOk;
-extern String lastMQTTConnection;
-extern String lastWIFiConnection;
-extern String lastBoot;
+/*
+  Configuration and state values, statically allocated to keep them off the heap,
+  the global names below are references to these fields so existing code keeps working.
+*/
+struct BootstrapConfig {
+    FixedString<33> deviceName = "XXX";
+    FixedString<16> microcontrollerIP = "XXX"; // dotted IP or "DHCP"
+    FixedString<33> qsid = "XXX";
+    FixedString<65> qpass = "XXX";
+    FixedString<65> OTApass = "XXX";
+    FixedString<254> mqttIP = "XXX"; // IP address or a full DNS name
+    FixedString<6> mqttPort = "XXX";
+    FixedString<65> mqttuser = "XXX";
+    FixedString<65> mqttpass = "XXX";
+    FixedString<128> mqttWillTopic = "0";
+    FixedString<128> mqttWillPayload = "0";
+    FixedString<65> additionalParam = "XXX";
+    FixedString<18> MAC = "";
+    FixedString<16> haVersion = "";
+    FixedString<16> firmwareVersion = "";
+    FixedString<33> timedate = "OFF";
+    FixedString<11> date = "OFF";
+    FixedString<6> currentime = "OFF";
+    FixedString<33> lastMQTTConnection = "OFF";
+    FixedString<33> lastWIFiConnection = "OFF";
+    FixedString<33> lastBoot = " ";
+
+    uint16_t getMqttPort() const { return (uint16_t) strtoul(mqttPort.c_str(), nullptr, 10); }
+
+    IPAddress getMqttIp() const { return toIp(mqttIP.c_str()); }
+
+    bool isDhcp() const { return microcontrollerIP == "DHCP"; }
+
+    IPAddress getMicrocontrollerIp() const { return toIp(microcontrollerIP.c_str()); }
+
+    static IPAddress toIp(const char *text) {
+        IPAddress ip;
+        ip.fromString(text);
+        return ip;
+    }
+};
+
+extern BootstrapConfig bootstrapConfig;
+
+extern FixedString<33> &lastMQTTConnection;
+extern FixedString<33> &lastWIFiConnection;
+extern FixedString<33> &lastBoot;
 
 extern bool screenSaverTriggered;
 
 extern bool lastPageScrollTriggered;
 extern int yoffset;
 
-extern String haVersion;
-extern String firmwareVersion;
-extern String MAC;
-extern String deviceName;
-extern String microcontrollerIP;
+extern FixedString<16> &haVersion;
+extern FixedString<16> &firmwareVersion;
+extern FixedString<18> &MAC;
+extern FixedString<33> &deviceName;
+extern FixedString<16> &microcontrollerIP;
 extern IPAddress currentWiFiIp;
 extern bool dhcpInUse;
 extern int8_t ethd;
@@ -48,22 +94,24 @@ extern int8_t mosi;
 extern int8_t miso;
 extern int8_t sclk;
 extern int8_t cs;
+extern int8_t interrupt;
+extern int8_t rst;
 #endif
-extern String qsid;
-extern String qpass;
-extern String OTApass;
-extern String mqttIP;
-extern String mqttPort;
-extern String mqttuser;
-extern String mqttpass;
-extern String mqttWillTopic;
-extern String mqttWillPayload;
+extern FixedString<33> &qsid;
+extern FixedString<65> &qpass;
+extern FixedString<65> &OTApass;
+extern FixedString<254> &mqttIP;
+extern FixedString<6> &mqttPort;
+extern FixedString<65> &mqttuser;
+extern FixedString<65> &mqttpass;
+extern FixedString<128> &mqttWillTopic;
+extern FixedString<128> &mqttWillPayload;
 extern int mqttWillQOS;
 extern bool mqttWillRetain;
 extern bool mqttCleanSession;
 extern bool mqttConnected;
 extern bool blockingMqtt;
-extern String additionalParam;
+extern FixedString<65> &additionalParam;
 extern bool ethConnected;
 extern bool restartRequested;
 extern unsigned long restartAt;
@@ -75,9 +123,9 @@ extern bool ledTriggered;
 extern int blinkCounter;
 extern const int blinkTimes; // 6 equals to 3 blink on and 3 off
 
-extern String timedate;
-[[maybe_unused]] extern String date;
-[[maybe_unused]] extern String currentime;
+extern FixedString<33> &timedate;
+[[maybe_unused]] extern FixedString<11> &date;
+[[maybe_unused]] extern FixedString<6> &currentime;
 extern String ERROR;
 
 extern int wifiReconnectAttemp;
@@ -155,13 +203,18 @@ static const unsigned char HABIGLOGO[] PROGMEM = {
 class Helpers {
 
 public:
-    static void smartPrint(String msg);
+    static Print &smartOutput(); // display when enabled, Serial otherwise
+
+    // F() strings, C strings, Strings, numbers and Printable (ex: IPAddress) are printed as they are, no String is created
+    template<typename T>
+    static void smartPrint(const T &msg) { smartOutput().print(msg); }
 
-    static void smartPrintln(String msg);
+    template<typename T>
+    static void smartPrintln(const T &msg) { smartOutput().println(msg); }
 
-    static void smartPrint(int msg);
+    static void smartPrintln();
 
-    static void smartPrintln(int msg);
+    static void smartPrintf(const char *format, ...); // format can be in flash (PSTR), output longer than 128 chars is truncated
 
     void smartDisplay();
 
@@ -171,6 +224,23 @@ public:
 
     static String getValue(String string);
 
+    // read a value of the setup file into a config field, values that don't fit are logged
+    template<size_t N>
+    static void readConfig(FixedString<N> &field, JsonVariantConst value, const char *key) {
+      bool fits;
+      if (value.is<const char *>()) {
+        fits = field.assign(value.as<const char *>());
+      } else {
+        // numbers are written as text like as<String>() does, without a temporary String
+        char text[N];
+        serializeJson(value, text, sizeof(text));
+        fits = field.assign(text) && measureJson(value) < N;
+      }
+      if (!fits) {
+        LOG_W("CONFIG", "%s is longer than %u chars, truncated", key, (unsigned) FixedString<N>::capacity());
+      }
+    }
+
     [[maybe_unused]] static long versionNumberToNumber(const String &latestReleaseStr);
 
     [[maybe_unused]] static char *string2char(String command);
@@ -0,0 +1,42 @@
+/*
+  HelpersPrint.cpp - Display and Serial output, apart from the board code so that the native tests can build it
+  
+  Copyright © 2020 - 2026  Davide Perini
+  
+  Permission is hereby granted, free of charge, to any person obtaining a copy of 
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  copies of the Software, and to permit persons to whom the Software is 
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in 
+  all copies or substantial portions of the Software.
+  
+  You should have received a copy of the MIT License along with this program.  
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "Helpers.h"
+#include <stdarg.h>
+
+Print &Helpers::smartOutput() {
+#if (DISPLAY_ENABLED)
+  return display;
+#else
+  return Serial;
+#endif
+}
+
+void Helpers::smartPrintln() {
+  smartOutput().println();
+}
+
+void Helpers::smartPrintf(const char *format, ...) {
+  char buffer[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf_P(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  smartOutput().print(buffer);
+}
@@ -0,0 +1,244 @@
+/*
+  ImprovParser.cpp - Improv Serial and DPSETH packet parsers
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "ImprovParser.h"
+
+void ImprovParser::reset() {
+  packetByte = 0;
+  packetLen = 9;
+  checksum = 0;
+  rpcCommandType = 0;
+  headerOk = true;
+  headerEthOk = true;
+}
+
+// feed a single byte to the Improv state machine
+uint8_t ImprovParser::feed(uint8_t next) {
+  const uint8_t header[6] = {'I', 'M', 'P', 'R', 'O', 'V'};
+  const uint8_t headerEth[6] = {'D', 'P', 'S', 'E', 'T', 'H'};
+  uint8_t event = Improv_None;
+  switch (packetByte) {
+    case ImprovPacketByte::Version:
+      if (next != IMPROV_VERSION) {
+        reset();
+        return Improv_Invalid;
+      }
+      break;
+    case ImprovPacketByte::PacketType:
+      if (next != ImprovPacketType::RPC_Command) {
+        reset();
+        return Improv_Invalid;
+      }
+      event = Improv_Rpc_Started;
+      break;
+    case ImprovPacketByte::Length:
+      packetLen = 9 + next;
+      break;
+    case ImprovPacketByte::RPC_CommandType:
+      rpcCommandType = next;
+      break;
+    default: {
+      if (packetByte >= packetLen) { //end of packet, check checksum match
+        bool valid = checksum == next;
+        uint8_t commandType = rpcCommandType;
+        reset();
+        // the command type and the data are kept for the caller until the next packet
+        rpcCommandType = commandType;
+        return valid ? Improv_Rpc_Command : Improv_Bad_Checksum;
+      }
+      if (packetByte < 6) { //check header
+        headerOk = headerOk && next == header[packetByte];
+        headerEthOk = headerEthOk && next == headerEth[packetByte];
+        if (!headerOk && !headerEthOk) {
+          reset();
+          return Improv_Invalid;
+        }
+        // This is a custom dpsoftware improv protocol
+        if (packetByte == 5 && headerEthOk) {
+          reset();
+          return Improv_Dpseth_Header;
+        }
+      } else if (packetByte > 9) { //RPC data
+        if (packetByte - 10 >= IMPROV_RPC_DATA_SIZE - 1) { //prevent buffer overflow, the data is null terminated
+          reset();
+          return Improv_Invalid;
+        }
+        rpcData[packetByte - 10] = (char) next;
+        rpcData[packetByte - 9] = 0;
+      }
+    }
+  }
+  checksum += next;
+  packetByte++;
+  return event;
+}
+
+void DpsethParser::reset() {
+  state = Dpseth_Idle;
+  length = 0;
+  index = 0;
+  crc = 0xFFFF;
+  receivedCrc = 0;
+  legacyLines = 0;
+}
+
+void DpsethParser::start() {
+  reset();
+  state = Dpseth_Version;
+}
+
+// CRC-16/CCITT-FALSE, used to validate DPSETH packets
+uint16_t DpsethParser::crc16(uint16_t crc, uint8_t data) {
+  crc ^= (uint16_t) data << 8;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+const char *DpsethParser::fieldName(uint8_t type) {
+  switch (type) {
+    case Field_Device_Name: return "deviceName";
+    case Field_Microcontroller_IP: return "microcontrollerIP";
+    case Field_Qsid: return "qsid";
+    case Field_Qpass: return "qpass";
+    case Field_OTA_Pass: return "OTApass";
+    case Field_Mqtt_IP: return "mqttIP";
+    case Field_Mqtt_Port: return "mqttPort";
+    case Field_Mqtt_User: return "mqttuser";
+    case Field_Mqtt_Pass: return "mqttpass";
+    case Field_Eth_Device: return "ethd";
+    case Field_Eth_Miso: return "miso";
+    case Field_Eth_Mosi: return "mosi";
+    case Field_Eth_Sclk: return "sclk";
+    case Field_Eth_Cs: return "cs";
+    case Field_Additional_Param: return "additionalParam";
+    case Field_Mqtt_Broker: return "brokers";
+    case Field_Eth_Interrupt: return "int";
+    case Field_Eth_Reset: return "rst";
+    default: return nullptr;
+  }
+}
+
+int16_t DpsethParser::brokerPortSeparator(const char *value, uint8_t length) {
+  for (int16_t i = (int16_t) length - 1; i >= 0; i--) {
+    if (value[i] == ':') return i;
+  }
+  return -1;
+}
+
+// feed a single byte to the DPSETH state machine, the DPSETH header has already been consumed by ImprovParser
+uint8_t DpsethParser::feed(uint8_t next) {
+  switch (state) {
+    case Dpseth_Version:
+      if (next == DPSETH_VERSION) {
+        crc = crc16(0xFFFF, next);
+        state = Dpseth_Length_High;
+      } else {
+        // legacy packets have no version byte, this is the first byte of the first line
+        state = Dpseth_Legacy;
+        return feed(next);
+      }
+      break;
+    case Dpseth_Length_High:
+      crc = crc16(crc, next);
+      length = (uint16_t) next << 8;
+      state = Dpseth_Length_Low;
+      break;
+    case Dpseth_Length_Low:
+      crc = crc16(crc, next);
+      length |= next;
+      if (length > DPSETH_MAX_PAYLOAD) {
+        reset();
+        return Dpseth_Too_Big;
+      }
+      state = length > 0 ? Dpseth_Payload : Dpseth_Crc_High;
+      break;
+    case Dpseth_Payload:
+      crc = crc16(crc, next);
+      payload[index++] = next;
+      if (index >= length) {
+        state = Dpseth_Crc_High;
+      }
+      break;
+    case Dpseth_Crc_High:
+      receivedCrc = (uint16_t) next << 8;
+      state = Dpseth_Crc_Low;
+      break;
+    case Dpseth_Crc_Low: {
+      receivedCrc |= next;
+      bool valid = receivedCrc == crc;
+      // the payload length is kept so that the fields can be read
+      state = Dpseth_Idle;
+      if (!valid) {
+        reset();
+        return Dpseth_Bad_Crc;
+      }
+      return Dpseth_Received;
+    }
+    case Dpseth_Legacy:
+      if (index >= DPSETH_MAX_PAYLOAD) {
+        reset();
+        return Dpseth_Too_Big;
+      }
+      payload[index++] = next;
+      if (next == '\n' && ++legacyLines >= DPSETH_LEGACY_FIELDS) {
+        state = Dpseth_Idle;
+        return Dpseth_Legacy_Received;
+      }
+      break;
+    default:
+      reset();
+      break;
+  }
+  return Dpseth_None;
+}
+
+// walk the TLV fields of a validated DPSETH packet
+uint8_t DpsethParser::nextField(uint16_t &pos, DpsethRecord &field) const {
+  if (pos + 2 > length) return Field_End;
+  field.type = payload[pos];
+  field.length = payload[pos + 1];
+  pos += 2;
+  if (pos + field.length > length) return Field_Truncated;
+  field.value = (const char *) payload + pos;
+  pos += field.length;
+  return Field_Read;
+}
+
+// legacy packets carry 15 newline terminated fields in a fixed order, the first one is unused
+bool DpsethParser::nextLegacyField(uint16_t &pos, uint8_t &line, DpsethRecord &field) const {
+  static const uint8_t legacyFields[DPSETH_LEGACY_FIELDS] = {0, Field_Device_Name, Field_Microcontroller_IP, Field_Qsid,
+                                                             Field_Qpass, Field_OTA_Pass, Field_Mqtt_IP, Field_Mqtt_Port,
+                                                             Field_Mqtt_User, Field_Mqtt_Pass, Field_Eth_Device,
+                                                             Field_Eth_Miso, Field_Eth_Mosi, Field_Eth_Sclk, Field_Eth_Cs};
+  if (line >= DPSETH_LEGACY_FIELDS) return false;
+  for (uint16_t i = pos; i < index; i++) {
+    if (payload[i] != '\n') continue;
+    // fields longer than 64 chars were truncated by the previous implementation too
+    uint16_t len = i - pos;
+    field.type = legacyFields[line];
+    field.value = (const char *) payload + pos;
+    field.length = len > DPSETH_LEGACY_FIELD_SIZE ? DPSETH_LEGACY_FIELD_SIZE : len;
+    pos = i + 1;
+    line++;
+    return true;
+  }
+  return false;
+}
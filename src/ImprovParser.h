@@ -0,0 +1,188 @@
+/*
+  ImprovParser.h - Improv Serial and DPSETH packet parsers
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_IMPROV_PARSER_H
+#define _DPSOFTWARE_IMPROV_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define IMPROV_VERSION 1
+#define IMPROV_RPC_DATA_SIZE 128
+
+/*
+  DPSETH is a custom dpsoftware provisioning packet sent on the same serial line used by Improv.
+  Framed packet (version 2):
+    'D' 'P' 'S' 'E' 'T' 'H' | version | length (2 bytes, big endian) | fields | CRC-16/CCITT-FALSE (2 bytes, big endian)
+  every field is a TLV record: type (1 byte) | value length (1 byte) | value,
+  fields can be sent in any order, unknown types are skipped, the CRC covers version, length and fields.
+  Legacy packets (15 newline terminated fields after the header) are still accepted.
+*/
+#define DPSETH_VERSION 2
+#define DPSETH_LEGACY_FIELDS 15
+#define DPSETH_LEGACY_FIELD_SIZE 64 // longer legacy fields are truncated
+#ifndef DPSETH_MAX_PAYLOAD
+#define DPSETH_MAX_PAYLOAD 512
+#endif
+
+enum ImprovPacketType {
+    Current_State = 0x01,
+    Error_State = 0x02,
+    RPC_Command = 0x03,
+    RPC_Response = 0x04
+};
+
+enum ImprovPacketByte {
+    Version = 6,
+    PacketType = 7,
+    Length = 8,
+    RPC_CommandType = 9
+};
+
+enum ImprovRPCType {
+    Command_Wifi = 0x01,
+    Request_State = 0x02,
+    Request_Info = 0x03
+};
+
+// result of ImprovParser::feed()
+enum ImprovParserEvent {
+    Improv_None, // byte consumed, the packet is not complete
+    Improv_Invalid, // wrong header, version, packet type or too much data, the parser is reset
+    Improv_Rpc_Started, // the packet type of an RPC command has been received
+    Improv_Rpc_Command, // complete RPC command, see getRpcCommandType() and getRpcData()
+    Improv_Bad_Checksum,
+    Improv_Dpseth_Header // DPSETH header received, the next bytes go to DpsethParser
+};
+
+enum DpsethParserState {
+    Dpseth_Idle,
+    Dpseth_Version,
+    Dpseth_Length_High,
+    Dpseth_Length_Low,
+    Dpseth_Payload,
+    Dpseth_Crc_High,
+    Dpseth_Crc_Low,
+    Dpseth_Legacy
+};
+
+// result of DpsethParser::feed()
+enum DpsethParserEvent {
+    Dpseth_None, // byte consumed, the packet is not complete
+    Dpseth_Received, // framed packet with a valid CRC, read it with nextField()
+    Dpseth_Legacy_Received, // legacy packet, read it with nextLegacyField()
+    Dpseth_Too_Big,
+    Dpseth_Bad_Crc
+};
+
+// result of DpsethParser::nextField()
+enum DpsethFieldResult {
+    Field_End,
+    Field_Read,
+    Field_Truncated
+};
+
+enum DpsethField {
+    Field_Device_Name = 0x01,
+    Field_Microcontroller_IP = 0x02,
+    Field_Qsid = 0x03,
+    Field_Qpass = 0x04,
+    Field_OTA_Pass = 0x05,
+    Field_Mqtt_IP = 0x06,
+    Field_Mqtt_Port = 0x07,
+    Field_Mqtt_User = 0x08,
+    Field_Mqtt_Pass = 0x09,
+    Field_Eth_Device = 0x0A,
+    Field_Eth_Miso = 0x0B,
+    Field_Eth_Mosi = 0x0C,
+    Field_Eth_Sclk = 0x0D,
+    Field_Eth_Cs = 0x0E,
+    Field_Additional_Param = 0x0F,
+    Field_Mqtt_Broker = 0x10, // repeatable, "host:port" appended to the "brokers" list of BrokerManager
+    Field_Eth_Interrupt = 0x11,
+    Field_Eth_Reset = 0x12
+};
+
+// a field of a received DPSETH packet, value points into the parser buffer and is not terminated
+struct DpsethRecord {
+    uint8_t type;
+    const char *value;
+    uint8_t length;
+};
+
+/*
+  Improv Serial state machine, fed one byte at a time so that it never waits for bytes not yet received.
+  It has no dependency on the serial port or on WiFi, the caller acts on the returned events.
+*/
+class ImprovParser {
+
+private:
+    uint16_t packetByte = 0;
+    uint8_t packetLen = 9;
+    uint8_t checksum = 0;
+    uint8_t rpcCommandType = 0;
+    bool headerOk = true;
+    bool headerEthOk = true;
+    char rpcData[IMPROV_RPC_DATA_SIZE] = {};
+
+public:
+    void reset();
+
+    uint8_t feed(uint8_t next); // returns an ImprovParserEvent
+
+    bool isReceiving() const { return packetByte > 0; }
+
+    uint8_t getRpcCommandType() const { return rpcCommandType; }
+
+    char *getRpcData() { return rpcData; }
+};
+
+/*
+  DPSETH state machine, started by the caller when ImprovParser returns Improv_Dpseth_Header.
+  The payload is kept until the next packet starts so that the fields can be read after Dpseth_Received.
+*/
+class DpsethParser {
+
+private:
+    uint8_t state = Dpseth_Idle;
+    uint16_t length = 0;
+    uint16_t index = 0;
+    uint16_t crc = 0xFFFF;
+    uint16_t receivedCrc = 0;
+    uint8_t legacyLines = 0;
+    uint8_t payload[DPSETH_MAX_PAYLOAD];
+
+public:
+    void reset();
+
+    void start(); // the DPSETH header has been consumed by ImprovParser
+
+    bool isActive() const { return state != Dpseth_Idle; }
+
+    uint8_t feed(uint8_t next); // returns a DpsethParserEvent
+
+    uint8_t nextField(uint16_t &pos, DpsethRecord &field) const; // TLV fields of a framed packet, start with pos = 0
+    bool nextLegacyField(uint16_t &pos, uint8_t &line, DpsethRecord &field) const; // fields of a legacy packet, start with pos = line = 0
+
+    static uint16_t crc16(uint16_t crc, uint8_t data); // CRC-16/CCITT-FALSE, start with 0xFFFF
+    static const char *fieldName(uint8_t type); // json key used in setup.json
+    static int16_t brokerPortSeparator(const char *value, uint8_t length); // last ':' of a "host:port" field, -1 if missing
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+  JsonArena.cpp - Preallocated memory arenas for ArduinoJson documents
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "JsonArena.h"
+
+// every block starts with its size, blocks and sizes are 8 bytes aligned
+#define JSON_ARENA_ALIGN 8
+#define JSON_ARENA_HEADER JSON_ARENA_ALIGN
+#define JSON_ARENA_ALIGNED(size) (((size) + JSON_ARENA_ALIGN - 1) & ~((size_t) JSON_ARENA_ALIGN - 1))
+
+// the scratch arena is shared by the application loop and the network task
+#if defined(ARDUINO_ARCH_ESP32)
+static portMUX_TYPE arenaMux = portMUX_INITIALIZER_UNLOCKED;
+#define ARENA_LOCK() portENTER_CRITICAL(&arenaMux)
+#define ARENA_UNLOCK() portEXIT_CRITICAL(&arenaMux)
+#else
+#define ARENA_LOCK()
+#define ARENA_UNLOCK()
+#endif
+
+alignas(JSON_ARENA_ALIGN) static uint8_t messageArenaBuffer[JSON_ARENA_SIZE > 0 ? JSON_ARENA_SIZE : 1];
+alignas(JSON_ARENA_ALIGN) static uint8_t bigArenaBuffer[JSON_BIG_ARENA_SIZE > 0 ? JSON_BIG_ARENA_SIZE : 1];
+alignas(JSON_ARENA_ALIGN) static uint8_t scratchArenaBuffer[JSON_SCRATCH_ARENA_SIZE > 0 ? JSON_SCRATCH_ARENA_SIZE : 1];
+
+JsonArena messageArena(messageArenaBuffer, JSON_ARENA_SIZE);
+JsonArena bigArena(bigArenaBuffer, JSON_BIG_ARENA_SIZE);
+JsonArena scratchArena(scratchArenaBuffer, JSON_SCRATCH_ARENA_SIZE);
+
+bool JsonArena::owns(const void *ptr) const {
+  return capacity > 0 && ptr >= buffer && ptr < buffer + capacity;
+}
+
+// called with the lock held, nullptr when the block doesn't fit
+void *JsonArena::allocateInArena(size_t size) {
+  size_t needed = JSON_ARENA_HEADER + JSON_ARENA_ALIGNED(size);
+  if (offset + needed > capacity) {
+    return nullptr;
+  }
+  uint8_t *block = buffer + offset;
+  *(uint32_t *) block = size;
+  lastBlock = offset;
+  offset += needed;
+  liveBlocks++;
+  stats.allocations++;
+  stats.used = offset;
+  if (offset > stats.peak) stats.peak = offset;
+  return block + JSON_ARENA_HEADER;
+}
+
+void *JsonArena::allocate(size_t size) {
+  ARENA_LOCK();
+  void *ptr = allocateInArena(size);
+  if (ptr == nullptr) {
+    stats.heapFallbacks++;
+  }
+  ARENA_UNLOCK();
+  return ptr != nullptr ? ptr : malloc(size);
+}
+
+void JsonArena::deallocate(void *ptr) {
+  if (ptr == nullptr) return;
+  if (!owns(ptr)) {
+    free(ptr);
+    return;
+  }
+  ARENA_LOCK();
+  liveBlocks--;
+  if (liveBlocks == 0) {
+    offset = 0;
+    lastBlock = SIZE_MAX;
+    stats.rewinds++;
+  } else if ((uint8_t *) ptr - JSON_ARENA_HEADER == buffer + lastBlock) {
+    offset = lastBlock;
+    lastBlock = SIZE_MAX;
+  }
+  stats.used = offset;
+  ARENA_UNLOCK();
+}
+
+void *JsonArena::reallocate(void *ptr, size_t newSize) {
+  if (ptr == nullptr) return allocate(newSize);
+  if (!owns(ptr)) return realloc(ptr, newSize);
+  ARENA_LOCK();
+  uint8_t *block = (uint8_t *) ptr - JSON_ARENA_HEADER;
+  uint32_t oldSize = *(uint32_t *) block;
+  if (block == buffer + lastBlock) {
+    // the last block grows or shrinks in place
+    size_t end = lastBlock + JSON_ARENA_HEADER + JSON_ARENA_ALIGNED(newSize);
+    if (end <= capacity) {
+      *(uint32_t *) block = newSize;
+      offset = end;
+      stats.used = offset;
+      if (offset > stats.peak) stats.peak = offset;
+      ARENA_UNLOCK();
+      return ptr;
+    }
+  } else if (newSize <= oldSize) {
+    *(uint32_t *) block = newSize;
+    ARENA_UNLOCK();
+    return ptr;
+  }
+  ARENA_UNLOCK();
+  void *moved = allocate(newSize);
+  if (moved == nullptr) return nullptr;
+  memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+  deallocate(ptr);
+  return moved;
+}
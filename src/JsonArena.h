@@ -0,0 +1,71 @@
+/*
+  JsonArena.h - Preallocated memory arenas for ArduinoJson documents
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_JSON_ARENA_H
+#define _DPSOFTWARE_JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+
+struct JsonArenaStats {
+    uint32_t allocations; // blocks allocated in the arena
+    uint32_t heapFallbacks; // blocks allocated on the heap because the arena was full
+    uint32_t rewinds; // times the arena was emptied
+    uint32_t used; // bytes in use
+    uint32_t peak; // max bytes in use
+};
+
+/*
+  Bump allocator over a static buffer: blocks are carved one after the other and the arena rewinds
+  when the last live block is freed, this happens every time a document is cleared or deserialized again.
+  The last block can grow or shrink in place, this is how ArduinoJson grows strings and shrinks pools.
+  Blocks that don't fit are allocated on the heap, so a document never fails because the arena is small.
+*/
+class JsonArena : public ArduinoJson::Allocator {
+
+private:
+    uint8_t *buffer;
+    size_t capacity;
+    size_t offset = 0;
+    size_t lastBlock = SIZE_MAX; // offset of the last block, SIZE_MAX when it has been freed
+    uint32_t liveBlocks = 0;
+    JsonArenaStats stats = {};
+
+    bool owns(const void *ptr) const;
+
+    void *allocateInArena(size_t size);
+
+public:
+    JsonArena(uint8_t *arenaBuffer, size_t arenaSize) : buffer(arenaBuffer), capacity(arenaSize) {}
+
+    void *allocate(size_t size) override;
+
+    void deallocate(void *ptr) override;
+
+    void *reallocate(void *ptr, size_t newSize) override;
+
+    const JsonArenaStats &getStats() const { return stats; }
+};
+
+extern JsonArena messageArena; // BootstrapManager::jsonDoc
+extern JsonArena bigArena; // BootstrapManager::jsonDocBigSize
+extern JsonArena scratchArena; // short lived documents
+
+#endif
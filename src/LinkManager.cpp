@@ -0,0 +1,130 @@
+/*
+  LinkManager.cpp - WiFi/Ethernet link selection and failover
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "LinkManager.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <ETH.h>
+#include <WiFi.h>
+#include "Helpers.h"
+#include "Logger.h"
+#include "QueueManager.h"
+
+LinkStats LinkManager::stats = {};
+uint8_t LinkManager::wifiLoss = 0;
+uint8_t LinkManager::ethLoss = 0;
+unsigned long LinkManager::lastCheck = 0;
+unsigned long LinkManager::failoverStart = 0;
+volatile bool LinkManager::linkEvent = false;
+
+void LinkManager::begin() {
+  stats = {};
+  wifiLoss = 0;
+  ethLoss = 0;
+  failoverStart = 0;
+  linkEvent = true;
+}
+
+void LinkManager::linkChanged() {
+  linkEvent = true;
+}
+
+void LinkManager::reportPacketLoss(NetworkLink link, uint8_t percent) {
+  if (percent > 100) percent = 100;
+  uint8_t &loss = link == Link_Ethernet ? ethLoss : wifiLoss;
+  loss = (loss * 3 + percent) / 4;
+}
+
+int16_t LinkManager::scoreWifi() {
+  if (WiFi.status() != WL_CONNECTED) return 0;
+  int16_t score = 1 + WifiManager::getQuality() * 9 / 10 - wifiLoss;
+  return score > 1 ? score : 1;
+}
+
+int16_t LinkManager::scoreEth() {
+  if (!ethConnected || !ETH.linkUp() || ETH.localIP() == IPAddress(0, 0, 0, 0)) return 0;
+  int16_t score = ETH.linkSpeed() >= 100 ? 100 : 60;
+  if (!ETH.fullDuplex()) score -= 10;
+  score -= ethLoss;
+  return score > 1 ? score : 1;
+}
+
+void LinkManager::loop() {
+  if (failoverStart != 0 && QueueManager::getMqttClient().connected()) {
+    stats.lastFailoverMs = millis() - failoverStart;
+    if (stats.lastFailoverMs > stats.maxFailoverMs) stats.maxFailoverMs = stats.lastFailoverMs;
+    failoverStart = 0;
+    LOG_I("LINK", "MQTT connected %lu ms after the failover", (unsigned long) stats.lastFailoverMs);
+  }
+  if (!linkEvent && millis() - lastCheck < LINK_CHECK_INTERVAL) return;
+  linkEvent = false;
+  lastCheck = millis();
+  // the loss is measured on the active link only, the other one forgets its loss so that it can win back
+  uint8_t &inactiveLoss = stats.active == Link_Ethernet ? wifiLoss : ethLoss;
+  inactiveLoss = inactiveLoss * 3 / 4;
+  stats.wifiScore = scoreWifi();
+  stats.ethScore = scoreEth();
+  // a link that comes back up starts without the loss of its outage
+  if (stats.wifiScore == 0) wifiLoss = 0;
+  if (stats.ethScore == 0) ethLoss = 0;
+  int16_t activeScore = stats.active == Link_Ethernet ? stats.ethScore : stats.active == Link_WiFi ? stats.wifiScore : 0;
+  NetworkLink best = stats.ethScore >= stats.wifiScore ? Link_Ethernet : Link_WiFi;
+  int16_t bestScore = best == Link_Ethernet ? stats.ethScore : stats.wifiScore;
+  if (best == stats.active || bestScore == 0) return;
+  if (activeScore > 0 && bestScore < activeScore + LINK_HYSTERESIS) return;
+  activate(best);
+}
+
+void LinkManager::activate(NetworkLink link) {
+  LOG_W("LINK", "Switching to %s, WiFi score: %d, Ethernet score: %d",
+        link == Link_Ethernet ? "Ethernet" : "WiFi", stats.wifiScore, stats.ethScore);
+  bool firstLink = stats.active == Link_None;
+  stats.active = link;
+  if (link == Link_Ethernet) {
+    ETH.setDefault();
+    microcontrollerIP = ETH.localIP().toString();
+  } else {
+    WiFi.STA.setDefault();
+    microcontrollerIP = WiFi.localIP().toString();
+  }
+  if (firstLink) return;
+  stats.failovers++;
+  // the socket is bound to the old interface, it is opened again by the MQTT reconnection
+  PubSubClient &mqttClient = QueueManager::getMqttClient();
+  if (mqttIP.length() > 0) {
+    failoverStart = millis();
+    if (mqttClient.connected()) mqttClient.disconnect();
+  }
+}
+
+NetworkLink LinkManager::getActiveLink() {
+  return stats.active;
+}
+
+const LinkStats &LinkManager::getStats() {
+  return stats;
+}
+
+void LinkManager::addTo(JsonObject object) {
+  object["link"] = stats.active == Link_Ethernet ? "eth" : stats.active == Link_WiFi ? "wifi" : "none";
+  object["linkFailovers"] = stats.failovers;
+  object["linkFailoverMs"] = stats.lastFailoverMs;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+  LinkManager.h - WiFi/Ethernet link selection and failover
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_LINK_MANAGER_H
+#define _DPSOFTWARE_LINK_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+enum NetworkLink {
+    Link_None,
+    Link_WiFi,
+    Link_Ethernet
+};
+
+struct LinkStats {
+    NetworkLink active; // link that carries the MQTT and OTA sockets
+    int16_t wifiScore; // 0 when the link is down
+    int16_t ethScore;
+    uint32_t failovers; // active link changes
+    uint32_t lastFailoverMs; // from the switch to the MQTT connection on the new link
+    uint32_t maxFailoverMs;
+};
+
+/*
+  Scores WiFi and Ethernet every LINK_CHECK_INTERVAL milliseconds, or as soon as a link event is received, and makes
+  the best one the default interface: Ethernet gets up to 100 points from speed and duplex, WiFi up to 90 from the RSSI,
+  both lose the recent packet loss percentage. The loss is measured on the active link only, the inactive one loses
+  a quarter of it on every check and a link that is down has none. The active link is replaced when it's down or when
+  the other one scores LINK_HYSTERESIS points more, the MQTT connection is then closed so that it is opened again on the new link.
+*/
+class LinkManager {
+
+private:
+    static LinkStats stats;
+    static uint8_t wifiLoss;
+    static uint8_t ethLoss;
+    static unsigned long lastCheck;
+    static unsigned long failoverStart;
+    static volatile bool linkEvent;
+
+    static int16_t scoreWifi();
+
+    static int16_t scoreEth();
+
+    static void activate(NetworkLink link);
+
+public:
+    static void begin();
+
+    static void loop(); // called by the network loop
+
+    static void linkChanged(); // a link went up or down, evaluate on the next loop
+
+    static void reportPacketLoss(NetworkLink link, uint8_t percent); // feed the loss measured on a link, smoothed
+
+    static NetworkLink getActiveLink();
+
+    static const LinkStats &getStats();
+
+    static void addTo(JsonObject object); // link fields for the state message
+};
+
+#endif
+
+#endif
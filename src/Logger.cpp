@@ -0,0 +1,261 @@
+/*
+  Logger.cpp - Non blocking logger with levels and tags
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "Logger.h"
+#include <stdarg.h>
+#include <WiFiUdp.h>
+#include "Helpers.h"
+#include "QueueManager.h"
+
+#define LOG_RING_MASK (LOG_BUFFER_SIZE - 1)
+
+// lines can be logged by the application loop and by the network task at the same time
+#if defined(ARDUINO_ARCH_ESP32)
+static portMUX_TYPE loggerMux = portMUX_INITIALIZER_UNLOCKED;
+#define LOGGER_LOCK() portENTER_CRITICAL(&loggerMux)
+#define LOGGER_UNLOCK() portEXIT_CRITICAL(&loggerMux)
+#else
+#define LOGGER_LOCK()
+#define LOGGER_UNLOCK()
+#endif
+
+Logger logger;
+
+static const char LEVEL_CHARS[] = "NEWIDV";
+// syslog severity for every log level, facility is user (1)
+static const uint8_t SYSLOG_SEVERITY[] = {7, 3, 4, 6, 7, 7};
+static WiFiUDP syslogUdp;
+static IPAddress syslogIp;
+static bool syslogEnabled = false;
+
+void Logger::begin() {
+  syslogEnabled = strlen(LOG_SYSLOG_SERVER) > 0 && syslogIp.fromString(LOG_SYSLOG_SERVER);
+  LOGGER_LOCK();
+  remoteEnabled = syslogEnabled || strlen(LOG_MQTT_TOPIC) > 0;
+  remoteTail = head;
+  LOGGER_UNLOCK();
+}
+
+void Logger::setLevel(uint8_t newLevel) {
+  level = newLevel > LOG_LEVEL ? LOG_LEVEL : newLevel;
+}
+
+// space used by the slowest sink
+uint32_t Logger::usedBytes() const {
+  uint32_t used = head - serialTail;
+  if (remoteEnabled && head - remoteTail > used) {
+    used = head - remoteTail;
+  }
+  return used;
+}
+
+void Logger::copyIn(const char *data, size_t len) {
+  size_t index = head & LOG_RING_MASK;
+  size_t firstPart = LOG_BUFFER_SIZE - index;
+  if (firstPart > len) firstPart = len;
+  memcpy(ring + index, data, firstPart);
+  memcpy(ring, data + firstPart, len - firstPart);
+  head += len;
+}
+
+// a line is stored entirely or not at all, a full buffer never waits for the sinks
+bool Logger::push(uint8_t lineLevel, const char *prefix, size_t prefixLen, const char *body, size_t bodyLen) {
+  size_t len = prefixLen + bodyLen + 2;
+  LOGGER_LOCK();
+  if (len > LOG_BUFFER_SIZE - usedBytes()) {
+    dropped++;
+    LOGGER_UNLOCK();
+    return false;
+  }
+  ring[head++ & LOG_RING_MASK] = (char) lineLevel;
+  copyIn(prefix, prefixLen);
+  copyIn(body, bodyLen);
+  ring[head++ & LOG_RING_MASK] = '\n';
+  lineStart = true;
+  LOGGER_UNLOCK();
+  return true;
+}
+
+size_t Logger::formatPrefix(char *dest, size_t size, uint8_t lineLevel, const char *tag) {
+  int len = snprintf(dest, size, "[%8lu][%c][%s] ", (unsigned long) millis(), LEVEL_CHARS[lineLevel], tag);
+  if (len < 0) return 0;
+  return (size_t) len < size ? (size_t) len : size - 1;
+}
+
+void Logger::log(uint8_t lineLevel, const char *tag, const char *format, ...) {
+  if (!isEnabled(lineLevel)) return;
+  char line[LOG_LINE_SIZE];
+  size_t len = formatPrefix(line, sizeof(line), lineLevel, tag);
+  va_list args;
+  va_start(args, format);
+  int bodyLen = vsnprintf_P(line + len, sizeof(line) - len, format, args);
+  va_end(args);
+  if (bodyLen > 0) {
+    len += (size_t) bodyLen < sizeof(line) - len ? (size_t) bodyLen : sizeof(line) - len - 1;
+  }
+  push(lineLevel, line, len, nullptr, 0);
+}
+
+// compact JSON, pretty printing a message costs milliseconds at 115200 baud
+void Logger::logJson(uint8_t lineLevel, const char *tag, JsonVariantConst json) {
+  if (!isEnabled(lineLevel)) return;
+  char prefix[48];
+  size_t prefixLen = formatPrefix(prefix, sizeof(prefix), lineLevel, tag);
+  size_t jsonLen = measureJson(json);
+  if (prefixLen + jsonLen + 2 > LOG_BUFFER_SIZE) {
+    dropped++;
+    return;
+  }
+  char body[jsonLen + 1];
+  serializeJson(json, body, sizeof(body));
+  push(lineLevel, prefix, prefixLen, body, jsonLen);
+}
+
+// raw writes from Print, a level byte is added at the start of every line
+size_t Logger::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+  LOGGER_LOCK();
+  while (written < size && usedBytes() + 2 <= LOG_BUFFER_SIZE) {
+    if (lineStart) {
+      ring[head++ & LOG_RING_MASK] = (char) Log_Info;
+    }
+    char c = (char) buffer[written++];
+    ring[head++ & LOG_RING_MASK] = c;
+    lineStart = c == '\n';
+  }
+  if (written < size) {
+    dropped++;
+  }
+  LOGGER_UNLOCK();
+  return written;
+}
+
+size_t Logger::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+void Logger::drain() {
+  if (dropped != droppedReported) {
+    char note[48];
+    size_t noteLen = formatPrefix(note, sizeof(note), Log_Warn, "LOG");
+    int len = snprintf(note + noteLen, sizeof(note) - noteLen, "%lu lines dropped", (unsigned long) (dropped - droppedReported));
+    uint32_t droppedNow = dropped;
+    if (len > 0 && push(Log_Warn, note, noteLen + len, nullptr, 0)) {
+      droppedReported = droppedNow;
+    }
+  }
+  drainSerial();
+  if (remoteEnabled) {
+    drainRemote();
+  }
+}
+
+// write only what the UART can take without waiting
+void Logger::drainSerial() {
+  int room = Serial.availableForWrite();
+  char chunk[64];
+  while (room > 0) {
+    size_t len = 0;
+    LOGGER_LOCK();
+    while (serialTail != head && len < sizeof(chunk) && len < (size_t) room) {
+      char c = ring[serialTail++ & LOG_RING_MASK];
+      if ((uint8_t) c > Log_Verbose) {
+        chunk[len++] = c;
+      }
+    }
+    LOGGER_UNLOCK();
+    if (len == 0) break;
+    Serial.write((const uint8_t *) chunk, len);
+    room -= (int) len;
+  }
+}
+
+// lines logged while the network is down are not sent to the remote sinks
+void Logger::drainRemote() {
+  bool networkUp = WiFi.status() == WL_CONNECTED || ethConnected;
+  if (!networkUp || (!syslogEnabled && !mqttConnected)) {
+    LOGGER_LOCK();
+    remoteTail = head;
+    LOGGER_UNLOCK();
+    return;
+  }
+  char line[LOG_LINE_SIZE];
+  for (uint8_t sent = 0; sent < LOG_REMOTE_BATCH; sent++) {
+    uint8_t lineLevel = Log_Info;
+    size_t len = 0;
+    bool complete = false;
+    LOGGER_LOCK();
+    uint32_t pos = remoteTail;
+    while (pos != head) {
+      char c = ring[pos++ & LOG_RING_MASK];
+      if (c == '\n') {
+        complete = true;
+        break;
+      }
+      if ((uint8_t) c <= Log_Verbose) {
+        lineLevel = (uint8_t) c;
+      } else if (len < sizeof(line) - 1) {
+        line[len++] = c;
+      }
+    }
+    // a raw write can still be in progress
+    if (complete) {
+      remoteTail = pos;
+    }
+    LOGGER_UNLOCK();
+    if (!complete) break;
+    line[len] = '\0';
+    sendRemote(lineLevel, line, len);
+  }
+}
+
+void Logger::sendRemote(uint8_t lineLevel, const char *line, size_t len) {
+  if (syslogEnabled) {
+    // RFC 3164 without timestamp, the collector adds the reception time
+    char header[48];
+    int headerLen = snprintf(header, sizeof(header), "<%u>%s: ", 8 + SYSLOG_SEVERITY[lineLevel], deviceName.c_str());
+    if (headerLen > (int) sizeof(header) - 1) headerLen = sizeof(header) - 1;
+    syslogUdp.beginPacket(syslogIp, LOG_SYSLOG_PORT);
+    syslogUdp.write((const uint8_t *) header, headerLen);
+    syslogUdp.write((const uint8_t *) line, len);
+    syslogUdp.endPacket();
+  }
+  if (strlen(LOG_MQTT_TOPIC) > 0 && mqttConnected) {
+    QueueManager::publish(LOG_MQTT_TOPIC, line, false);
+  }
+}
+
+// used before a restart, waits for the UART
+void Logger::flushBlocking() {
+  char chunk[64];
+  size_t len;
+  do {
+    len = 0;
+    LOGGER_LOCK();
+    while (serialTail != head && len < sizeof(chunk)) {
+      char c = ring[serialTail++ & LOG_RING_MASK];
+      if ((uint8_t) c > Log_Verbose) {
+        chunk[len++] = c;
+      }
+    }
+    LOGGER_UNLOCK();
+    Serial.write((const uint8_t *) chunk, len);
+  } while (len > 0);
+  Serial.flush();
+}
@@ -0,0 +1,137 @@
+/*
+  Logger.h - Non blocking logger with levels and tags
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_LOGGER_H
+#define _DPSOFTWARE_LOGGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of two");
+
+enum LogLevel {
+    Log_None = 0,
+    Log_Error = 1,
+    Log_Warn = 2,
+    Log_Info = 3,
+    Log_Debug = 4,
+    Log_Verbose = 5
+};
+
+/*
+  Log lines are formatted in the caller into a stack buffer and copied into a ring buffer,
+  bootstrapLoop() writes the ring buffer to Serial only when the UART has room for it, so logging never waits for the UART.
+  When the ring buffer is full the new line is dropped and counted.
+  Every line starts with a level byte, used by the remote sinks (syslog and MQTT) and skipped on Serial.
+  Logger is a Print, serializeJson(doc, logger) works as well, raw writes are logged as info.
+*/
+class Logger : public Print {
+
+private:
+    char ring[LOG_BUFFER_SIZE];
+    uint32_t head = 0; // bytes written since boot
+    uint32_t serialTail = 0; // bytes written to Serial since boot
+    uint32_t remoteTail = 0; // bytes sent to syslog or MQTT since boot
+    uint32_t dropped = 0;
+    uint32_t droppedReported = 0;
+    uint8_t level = LOG_LEVEL;
+    bool remoteEnabled = false;
+    bool lineStart = true; // next raw write starts a new line
+
+    uint32_t usedBytes() const;
+
+    void copyIn(const char *data, size_t len);
+
+    bool push(uint8_t lineLevel, const char *prefix, size_t prefixLen, const char *body, size_t bodyLen);
+
+    size_t formatPrefix(char *dest, size_t size, uint8_t lineLevel, const char *tag);
+
+    void drainSerial();
+
+    void drainRemote();
+
+    void sendRemote(uint8_t lineLevel, const char *line, size_t len);
+
+public:
+    void begin(); // enable the remote sinks configured via LOG_SYSLOG_SERVER and LOG_MQTT_TOPIC
+
+    void setLevel(uint8_t newLevel); // runtime level, levels above LOG_LEVEL are not compiled in
+
+    uint8_t getLevel() const { return level; }
+
+    bool isEnabled(uint8_t lineLevel) const { return lineLevel <= level; }
+
+    void log(uint8_t lineLevel, const char *tag, const char *format, ...);
+
+    void logJson(uint8_t lineLevel, const char *tag, JsonVariantConst json);
+
+    void drain(); // write the queued lines to Serial and to the remote sinks, called by bootstrapLoop()
+
+    void flushBlocking(); // write everything to Serial, waiting for the UART, use it before a restart
+
+    uint32_t getDropped() const { return dropped; }
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    using Print::write;
+};
+
+extern Logger logger;
+
+// format strings are kept in flash, disabled levels generate no code
+#if (LOG_LEVEL >= 1)
+#define LOG_E(tag, format, ...) logger.log(Log_Error, tag, PSTR(format), ##__VA_ARGS__)
+#define LOG_JSON_E(tag, json) logger.logJson(Log_Error, tag, json)
+#else
+#define LOG_E(tag, format, ...) do {} while (0)
+#define LOG_JSON_E(tag, json) do {} while (0)
+#endif
+#if (LOG_LEVEL >= 2)
+#define LOG_W(tag, format, ...) logger.log(Log_Warn, tag, PSTR(format), ##__VA_ARGS__)
+#define LOG_JSON_W(tag, json) logger.logJson(Log_Warn, tag, json)
+#else
+#define LOG_W(tag, format, ...) do {} while (0)
+#define LOG_JSON_W(tag, json) do {} while (0)
+#endif
+#if (LOG_LEVEL >= 3)
+#define LOG_I(tag, format, ...) logger.log(Log_Info, tag, PSTR(format), ##__VA_ARGS__)
+#define LOG_JSON_I(tag, json) logger.logJson(Log_Info, tag, json)
+#else
+#define LOG_I(tag, format, ...) do {} while (0)
+#define LOG_JSON_I(tag, json) do {} while (0)
+#endif
+#if (LOG_LEVEL >= 4)
+#define LOG_D(tag, format, ...) logger.log(Log_Debug, tag, PSTR(format), ##__VA_ARGS__)
+#define LOG_JSON_D(tag, json) logger.logJson(Log_Debug, tag, json)
+#else
+#define LOG_D(tag, format, ...) do {} while (0)
+#define LOG_JSON_D(tag, json) do {} while (0)
+#endif
+#if (LOG_LEVEL >= 5)
+#define LOG_V(tag, format, ...) logger.log(Log_Verbose, tag, PSTR(format), ##__VA_ARGS__)
+#define LOG_JSON_V(tag, json) logger.logJson(Log_Verbose, tag, json)
+#else
+#define LOG_V(tag, format, ...) do {} while (0)
+#define LOG_JSON_V(tag, json) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+/*
+  LoopProfiler.cpp - Latency profiler for the bootstrapLoop() stages
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "LoopProfiler.h"
+
+#if (LOOP_PROFILER_ENABLED)
+
+#include <ArduinoJson.h>
+#include "JsonArena.h"
+#include "QueueManager.h"
+#include "TaskScheduler.h"
+
+StageStats LoopProfiler::stages[Stage_Count];
+uint32_t LoopProfiler::cyclesPerMicro = 1;
+unsigned long LoopProfiler::loopEndMicros = 0;
+
+void LoopProfiler::begin() {
+  cyclesPerMicro = ESP.getCpuFreqMHz();
+  memset(stages, 0, sizeof(stages));
+  loopEndMicros = 0;
+  TaskScheduler::every(LOOP_PROFILER_INTERVAL, report);
+}
+
+const char *LoopProfiler::stageName(uint8_t stage) {
+  switch (stage) {
+    case Stage_Scheduler: return "scheduler";
+    case Stage_Improv: return "improv";
+    case Stage_WiFi: return "wifi";
+    case Stage_OTA: return "ota";
+    case Stage_MQTT: return "mqtt";
+    case Stage_Callback: return "callback";
+    case Stage_User: return "user";
+    default: return "unknown";
+  }
+}
+
+void LoopProfiler::record(uint8_t stage, uint32_t elapsed) {
+  StageStats &stats = stages[stage];
+  stats.count++;
+  stats.totalMicros += elapsed;
+  if (elapsed > stats.maxMicros) stats.maxMicros = elapsed;
+  if (elapsed > stats.worstMicros) stats.worstMicros = elapsed;
+  uint8_t bucket = 0;
+  while (elapsed > 0 && bucket < PROFILER_BUCKETS - 1) {
+    elapsed >>= 1;
+    bucket++;
+  }
+  stats.buckets[bucket]++;
+}
+
+void LoopProfiler::loopStart() {
+  // the user stage uses micros(), the application loop can be longer than a cycle counter wrap
+  if (loopEndMicros != 0) {
+    record(Stage_User, micros() - loopEndMicros);
+  }
+}
+
+void LoopProfiler::loopEnd() {
+  loopEndMicros = micros();
+}
+
+uint32_t LoopProfiler::endStage(uint8_t stage, uint32_t startCycles) {
+  uint32_t now = cycles();
+  record(stage, (now - startCycles) / cyclesPerMicro);
+  return now;
+}
+
+const StageStats &LoopProfiler::getStats(uint8_t stage) {
+  return stages[stage];
+}
+
+// upper bound of the histogram bucket containing the requested percentile
+uint32_t LoopProfiler::percentile(const StageStats &stats, uint8_t pct) {
+  uint32_t target = (uint32_t) (((uint64_t) stats.count * pct + 99) / 100);
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+    seen += stats.buckets[i];
+    if (seen >= target && seen > 0) {
+      return i == 0 ? 0 : (1UL << i) - 1;
+    }
+  }
+  return stats.maxMicros;
+}
+
+// print and publish the stats of the last window, then start a new window
+void LoopProfiler::report() {
+  JsonDocument doc(&scratchArena);
+  Serial.println(F("Loop profiler (us): stage count avg p50 p99 max worst"));
+  for (uint8_t i = 0; i < Stage_Count; i++) {
+    StageStats &stats = stages[i];
+    if (stats.count == 0) continue;
+    uint32_t avg = (uint32_t) (stats.totalMicros / stats.count);
+    uint32_t p50 = percentile(stats, 50);
+    uint32_t p99 = percentile(stats, 99);
+    Serial.printf("%-9s %lu %lu %lu %lu %lu %lu\n", stageName(i), (unsigned long) stats.count, (unsigned long) avg,
+                  (unsigned long) p50, (unsigned long) p99, (unsigned long) stats.maxMicros,
+                  (unsigned long) stats.worstMicros);
+    JsonObject stage = doc[stageName(i)].to<JsonObject>();
+    stage["count"] = stats.count;
+    stage["avg"] = avg;
+    stage["p50"] = p50;
+    stage["p99"] = p99;
+    stage["max"] = stats.maxMicros;
+    stage["worst"] = stats.worstMicros;
+    JsonArray histogram = stage["hist"].to<JsonArray>();
+    for (uint32_t bucket : stats.buckets) {
+      histogram.add(bucket);
+    }
+    uint32_t worst = stats.worstMicros;
+    memset(&stats, 0, sizeof(StageStats));
+    stats.worstMicros = worst;
+  }
+  if (strlen(LOOP_PROFILER_TOPIC) > 0 && mqttConnected) {
+    char buffer[measureJson(doc) + 1];
+    serializeJson(doc, buffer, sizeof(buffer));
+    QueueManager::publish(LOOP_PROFILER_TOPIC, buffer, false);
+  }
+}
+
+#endif
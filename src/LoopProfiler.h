@@ -0,0 +1,90 @@
+/*
+  LoopProfiler.h - Latency profiler for the bootstrapLoop() stages
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_LOOP_PROFILER_H
+#define _DPSOFTWARE_LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+enum LoopStage {
+    Stage_Scheduler,
+    Stage_Improv,
+    Stage_WiFi,
+    Stage_OTA,
+    Stage_MQTT,
+    Stage_Callback, // MQTT messages delivered from the message queue
+    Stage_User, // time spent outside bootstrapLoop(), in the application loop()
+    Stage_Count
+};
+
+// log2 buckets in microseconds: 0us, 1us, 2-3us, 4-7us ... the last bucket holds everything above 16ms
+#define PROFILER_BUCKETS 16
+
+#if (LOOP_PROFILER_ENABLED)
+
+struct StageStats {
+    uint32_t count;
+    uint64_t totalMicros;
+    uint32_t maxMicros; // worst time in the current report window
+    uint32_t worstMicros; // worst time since boot
+    uint32_t buckets[PROFILER_BUCKETS];
+};
+
+class LoopProfiler {
+
+private:
+    static StageStats stages[Stage_Count];
+    static uint32_t cyclesPerMicro;
+    static unsigned long loopEndMicros;
+
+    static void record(uint8_t stage, uint32_t elapsed);
+
+    static uint32_t percentile(const StageStats &stats, uint8_t pct);
+
+    static void report();
+
+public:
+    static void begin(); // start the periodic report
+    static inline uint32_t cycles() { return ESP.getCycleCount(); }
+    static void loopStart(); // account the time spent in the application loop
+    static void loopEnd();
+    static uint32_t endStage(uint8_t stage, uint32_t startCycles); // account a stage, returns the cycle counter
+    static const StageStats &getStats(uint8_t stage);
+    static const char *stageName(uint8_t stage);
+};
+
+#define PROFILER_LOOP_BEGIN() LoopProfiler::loopStart()
+#define PROFILER_BEGIN() uint32_t profilerCycles = LoopProfiler::cycles()
+#define PROFILER_RESTART() profilerCycles = LoopProfiler::cycles()
+#define PROFILER_STAGE(stage) profilerCycles = LoopProfiler::endStage(stage, profilerCycles)
+#define PROFILER_LOOP_END() LoopProfiler::loopEnd()
+
+#else
+
+// profiler disabled, no code is generated
+#define PROFILER_LOOP_BEGIN()
+#define PROFILER_BEGIN()
+#define PROFILER_RESTART()
+#define PROFILER_STAGE(stage)
+#define PROFILER_LOOP_END()
+
+#endif
+
+#endif
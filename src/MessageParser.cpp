@@ -0,0 +1,63 @@
+/*
+  MessageParser.cpp - Parse MQTT and HTTP messages into a JSON document
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "MessageParser.h"
+#include "Helpers.h"
+
+// non json messages are stored as {"value": "message"}
+JsonVariantConst MessageParser::parse(const char *payload, size_t length) {
+  DeserializationError error = deserializeJson(doc, payload, length);
+  if (error) {
+    JsonObject root = doc.to<JsonObject>();
+    root[VALUE] = JsonString(payload, length);
+    if (DEBUG_QUEUE_MSG) {
+      LOG_I("MQTT", "%.*s", (int) length, payload);
+    }
+  } else if (DEBUG_QUEUE_MSG) {
+    LOG_JSON_I("MQTT", doc);
+  }
+  return doc.as<JsonVariantConst>();
+}
+
+/********************************** PRINT THE MESSAGE ARRIVING FROM THE QUEUE **********************************/
+JsonVariantConst MessageParser::parseQueueMsgRef(const char *topic, const byte *payload, unsigned int length) {
+  if (DEBUG_QUEUE_MSG) {
+    LOG_I("MQTT", "QUEUE MSG ARRIVED [%s]", topic);
+  }
+  return parse((const char *) payload, length);
+}
+
+JsonDocument MessageParser::parseQueueMsg(char *topic, byte *payload, unsigned int length) {
+  parseQueueMsgRef(topic, payload, length);
+  return doc;
+}
+
+/********************************** PRINT THE MESSAGE ARRIVING FROM HTTP **********************************/
+JsonVariantConst MessageParser::parseHttpMsgRef(const char *payload, size_t length) {
+  return parse(payload, length);
+}
+
+JsonVariantConst MessageParser::parseHttpMsgRef(const String &payload) {
+  return parse(payload.c_str(), payload.length());
+}
+
+JsonDocument MessageParser::parseHttpMsg(String payload, unsigned int length) {
+  parseHttpMsgRef(payload.c_str(), length < payload.length() ? length : payload.length());
+  return doc;
+}
@@ -0,0 +1,53 @@
+/*
+  MessageParser.h - Parse MQTT and HTTP messages into a JSON document
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_MESSAGE_PARSER_H
+#define _DPSOFTWARE_MESSAGE_PARSER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/*
+  Messages are parsed into a document owned by the caller (BootstrapManager::jsonDoc),
+  non json messages are stored as {"value": "message"}.
+  The Ref methods return a view of the document, valid until the next message is parsed, nothing is copied,
+  parseQueueMsg() and parseHttpMsg() return a copy of the whole document.
+*/
+class MessageParser {
+
+private:
+    JsonDocument &doc;
+
+    JsonVariantConst parse(const char *payload, size_t length);
+
+public:
+    explicit MessageParser(JsonDocument &document) : doc(document) {}
+
+    JsonVariantConst parseQueueMsgRef(const char *topic, const byte *payload, unsigned int length);
+
+    JsonVariantConst parseHttpMsgRef(const char *payload, size_t length);
+
+    JsonVariantConst parseHttpMsgRef(const String &payload);
+
+    JsonDocument parseQueueMsg(char *topic, byte *payload, unsigned int length);
+
+    JsonDocument parseHttpMsg(String payload, unsigned int length);
+};
+
+#endif
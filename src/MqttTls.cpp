@@ -0,0 +1,125 @@
+/*
+  MqttTls.cpp - TLS transport for the MQTT client
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "MqttTls.h"
+
+#if (MQTT_TLS)
+#include <LittleFS.h>
+#if defined(ESP8266)
+#include <WiFiClientSecureBearSSL.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFiClientSecure.h>
+#endif
+#include "Logger.h"
+
+#if defined(ESP8266)
+static BearSSL::WiFiClientSecure tlsClient;
+static BearSSL::Session tlsSession;
+static BearSSL::X509List *trustAnchors = nullptr;
+#elif defined(ARDUINO_ARCH_ESP32)
+static WiFiClientSecure tlsClient;
+static char *caCert = nullptr;
+#endif
+
+MqttTlsStats MqttTls::stats = {};
+FixedString<254> MqttTls::probedHost;
+uint16_t MqttTls::probedPort = 0;
+
+Client &MqttTls::getClient() {
+  return tlsClient;
+}
+
+String MqttTls::readFile(const char *path) {
+  String content;
+  File file = LittleFS.open(path, "r");
+  if (file) {
+    content = file.readString();
+    content.trim();
+    file.close();
+  }
+  return content;
+}
+
+void MqttTls::begin() {
+  String ca = readFile("/mqtt_ca.pem");
+#if defined(ESP8266)
+  // a reconnection resumes the session, the key exchange is the slow part of the handshake
+  tlsClient.setSession(&tlsSession);
+  if (ca.length() > 0) {
+    // BearSSL checks the certificate dates, the clock must be set (configTime) before connecting
+    if (trustAnchors == nullptr) trustAnchors = new BearSSL::X509List(ca.c_str());
+    if (trustAnchors->getCount() == 0) {
+      // without a trust setting BearSSL refuses the connection
+      LOG_E("MQTT", "Invalid /mqtt_ca.pem, TLS connections will fail");
+      return;
+    }
+    tlsClient.setTrustAnchors(trustAnchors);
+    return;
+  }
+  String fingerprint = readFile("/mqtt_fingerprint.txt");
+  if (fingerprint.length() > 0) {
+    if (!tlsClient.setFingerprint(fingerprint.c_str())) {
+      LOG_E("MQTT", "Invalid /mqtt_fingerprint.txt, TLS connections will fail");
+    }
+    return;
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  tlsClient.setHandshakeTimeout(MQTT_TLS_HANDSHAKE_TIMEOUT);
+  if (ca.length() > 0) {
+    // the client keeps the pointer
+    if (caCert == nullptr) caCert = strdup(ca.c_str());
+    tlsClient.setCACert(caCert);
+    return;
+  }
+#endif
+  LOG_W("MQTT", "No CA or fingerprint in LittleFS, the broker is not verified");
+  tlsClient.setInsecure();
+}
+
+void MqttTls::beforeConnect(const char *host, uint16_t port) {
+#if defined(ESP8266)
+  if (probedPort == port && probedHost == host) return;
+  // the session of the previous broker can't be resumed by this one
+  if (probedPort != 0) tlsSession = BearSSL::Session();
+  probedHost = host;
+  probedPort = port;
+  // 16 KB receive buffer unless the broker accepts smaller TLS records, the client may always send small records
+  if (BearSSL::WiFiClientSecure::probeMaxFragmentLength(host, port, MQTT_TLS_RX_BUFFER)) {
+    tlsClient.setBufferSizes(MQTT_TLS_RX_BUFFER, MQTT_TLS_TX_BUFFER);
+  } else {
+    LOG_I("MQTT", "Broker %s doesn't support max fragment length, using the default TLS buffers", host);
+    tlsClient.setBufferSizes(16384, MQTT_TLS_TX_BUFFER);
+  }
+#endif
+}
+
+void MqttTls::connectResult(uint32_t elapsedMs, bool connected) {
+  if (!connected) return;
+  if (stats.connections == 0) stats.firstConnectMs = elapsedMs;
+  stats.connections++;
+  stats.lastConnectMs = elapsedMs;
+  if (elapsedMs > stats.maxConnectMs) stats.maxConnectMs = elapsedMs;
+  LOG_I("MQTT", "TLS connection in %lu ms", (unsigned long) elapsedMs);
+}
+
+const MqttTlsStats &MqttTls::getStats() {
+  return stats;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+  MqttTls.h - TLS transport for the MQTT client
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_MQTT_TLS_H
+#define _DPSOFTWARE_MQTT_TLS_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "Configuration.h"
+#include "FixedString.h"
+
+#if (MQTT_TLS)
+
+struct MqttTlsStats {
+    uint32_t connections; // successful MQTT connections over TLS
+    uint32_t firstConnectMs; // TCP + full handshake + MQTT connect
+    uint32_t lastConnectMs; // on ESP8266 a reconnection resumes the TLS session and skips the key exchange
+    uint32_t maxConnectMs;
+};
+
+/*
+  TLS client used by PubSubClient when MQTT_TLS is enabled, the broker is verified with the files in LittleFS:
+    /mqtt_ca.pem          CA certificate, or the self signed certificate of the broker
+    /mqtt_fingerprint.txt SHA1 fingerprint of the broker certificate, ESP8266 only
+  Without them the connection is encrypted but the broker is not verified.
+  On ESP8266 (BearSSL) the TLS session is kept between reconnections and the buffers are reduced to
+  MQTT_TLS_RX_BUFFER/MQTT_TLS_TX_BUFFER when the broker supports the max fragment length extension.
+  Each broker is probed when the client connects to it, a broker switch drops the session of the previous one.
+*/
+class MqttTls {
+
+private:
+    static MqttTlsStats stats;
+    static FixedString<254> probedHost;
+    static uint16_t probedPort;
+
+    static String readFile(const char *path);
+
+public:
+    static Client &getClient();
+
+    static void begin(); // load the broker verification from LittleFS
+
+    static void beforeConnect(const char *host, uint16_t port); // size the buffers for the broker when it changes
+
+    static void connectResult(uint32_t elapsedMs, bool connected); // time of the last connection
+
+    static const MqttTlsStats &getStats();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,347 @@
+/*
+  OtaManager.cpp - Compressed firmware updates
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "OtaManager.h"
+#include "WifiManager.h"
+#include "Logger.h"
+#include "DeltaPatch.h"
+#include <LittleFS.h>
+#include <memory>
+#if defined(ESP8266)
+#include <WiFiClientSecureBearSSL.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFiClientSecure.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#if (OTA_GZIP)
+#if __has_include(<miniz.h>)
+#include <miniz.h>
+#else
+#include <rom/miniz.h>
+#endif
+#endif
+#endif
+
+#define OTA_CHUNK_SIZE 1024
+#define OTA_GZIP_HEADER 10
+#define OTA_STREAM_TIMEOUT 10000
+
+OtaStats OtaManager::stats = {};
+uint8_t OtaManager::lastProgress = 0;
+
+void OtaManager::resetProgress() {
+  lastProgress = 0;
+}
+
+void OtaManager::progress(uint32_t done, uint32_t total) {
+#if defined(ARDUINO_ARCH_ESP32)
+  esp_task_wdt_reset();
+#endif
+  if (total == 0) return;
+  uint8_t percent = (uint64_t) done * 100 / total;
+  if (done != 0 && percent < lastProgress + OTA_PROGRESS_STEP && percent != 100) return;
+  lastProgress = percent;
+  Serial.printf("Progress: %u%%\r", percent);
+}
+
+// read up to size bytes, waiting for the network, 0 at the end of the stream
+static size_t readChunk(Stream &stream, uint8_t *buffer, size_t size, int32_t remaining) {
+  if (remaining == 0) return 0;
+  if (remaining > 0 && (size_t) remaining < size) size = remaining;
+  unsigned long start = millis();
+  while (stream.available() == 0) {
+    if (millis() - start > OTA_STREAM_TIMEOUT) return 0;
+    delay(1);
+  }
+  return stream.readBytes(buffer, size);
+}
+
+// reset the updater after a failure, otherwise every later update fails until reboot
+static void abortUpdate() {
+  if (!Update.isRunning()) return;
+#if defined(ESP8266)
+  // end() of an unfinished image resets the updater, nothing is installed
+  Update.end();
+#elif defined(ARDUINO_ARCH_ESP32)
+  Update.abort();
+#endif
+}
+
+static String readCa() {
+  String ca;
+  File file = LittleFS.open("/ota_ca.pem", "r");
+  if (file) {
+    ca = file.readString();
+    file.close();
+  }
+  return ca;
+}
+
+bool OtaManager::updateFromUrl(const char *url) {
+  stats = {};
+  resetProgress();
+  unsigned long start = millis();
+  // own clients, espClient carries the MQTT connection
+  WiFiClient client;
+#if defined(ESP8266)
+  BearSSL::WiFiClientSecure secureClient;
+  std::unique_ptr<BearSSL::X509List> trustAnchors;
+#elif defined(ARDUINO_ARCH_ESP32)
+  WiFiClientSecure secureClient;
+#endif
+  String ca;
+  bool https = strncmp(url, "https://", 8) == 0;
+  if (https) {
+    ca = readCa();
+    if (ca.length() > 0) {
+#if defined(ESP8266)
+      trustAnchors.reset(new BearSSL::X509List(ca.c_str()));
+      secureClient.setTrustAnchors(trustAnchors.get());
+#elif defined(ARDUINO_ARCH_ESP32)
+      secureClient.setCACert(ca.c_str());
+#endif
+    } else {
+      LOG_W("OTA", "No /ota_ca.pem in LittleFS, the update server is not verified");
+      secureClient.setInsecure();
+    }
+  }
+  HTTPClient http;
+  if (https) {
+    http.begin(secureClient, url);
+  } else {
+    http.begin(client, url);
+  }
+  int httpCode = http.GET();
+  if (httpCode != HTTP_CODE_OK) {
+    LOG_E("OTA", "Download failed, HTTP %d", httpCode);
+    http.end();
+    return false;
+  }
+  int32_t length = http.getSize();
+  bool ok = writeStream(*http.getStreamPtr(), length);
+  if (!ok) abortUpdate();
+  http.end();
+  stats.durationMs = millis() - start;
+  stats.success = ok;
+  if (ok) {
+    LOG_I("OTA", "Update written in %lu ms, %lu bytes received, %lu bytes of firmware%s",
+          (unsigned long) stats.durationMs, (unsigned long) stats.bytesReceived, (unsigned long) stats.bytesWritten,
+          stats.compressed ? ", gzip" : stats.patch ? ", patch" : "");
+  } else {
+#if defined(ESP8266)
+    LOG_E("OTA", "Update failed: %s", Update.getErrorString().c_str());
+#elif defined(ARDUINO_ARCH_ESP32)
+    LOG_E("OTA", "Update failed: %s", Update.errorString());
+#endif
+  }
+  return ok;
+}
+
+bool OtaManager::writeStream(Stream &stream, int32_t length) {
+  uint8_t buffer[OTA_CHUNK_SIZE];
+  size_t read = readChunk(stream, buffer, OTA_GZIP_HEADER, length);
+  if (read < 2) return false;
+  stats.bytesReceived = read;
+  stats.compressed = buffer[0] == 0x1F && buffer[1] == 0x8B;
+  stats.patch = DeltaPatch::isPatch(buffer, read);
+  if (stats.patch) {
+    return applyPatch(stream, length, buffer, read);
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  if (stats.compressed) {
+#if (OTA_GZIP)
+    return inflateStream(stream, length, buffer, read);
+#else
+    LOG_E("OTA", "gzip images are disabled, OTA_GZIP");
+    return false;
+#endif
+  }
+#endif
+  // plain images, and compressed images on ESP8266 that are decompressed by the bootloader
+#if defined(ESP8266)
+  uint32_t size = length > 0 ? (uint32_t) length : (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
+#elif defined(ARDUINO_ARCH_ESP32)
+  uint32_t size = length > 0 ? (uint32_t) length : UPDATE_SIZE_UNKNOWN;
+#endif
+  if (!Update.begin(size)) return false;
+  size_t total = read;
+  while (read > 0) {
+    if (Update.write(buffer, read) != read) return false;
+    stats.bytesWritten += read;
+    progress(total, length > 0 ? length : 0);
+    read = readChunk(stream, buffer, sizeof(buffer), length > 0 ? length - (int32_t) total : -1);
+    total += read;
+    stats.bytesReceived += read;
+  }
+  return Update.end(length <= 0);
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && (OTA_GZIP)
+// gzip header flags, RFC 1952
+#define GZIP_FHCRC 0x02
+#define GZIP_FEXTRA 0x04
+#define GZIP_FNAME 0x08
+#define GZIP_FCOMMENT 0x10
+
+// inflate the deflate stream of the gzip file into the OTA partition, the 32 KB dictionary is the output window
+bool OtaManager::inflateStream(Stream &stream, int32_t length, const uint8_t *head, size_t headLength) {
+  if (headLength < OTA_GZIP_HEADER || head[2] != 8) return false;
+  uint8_t flags = head[3];
+  int32_t remaining = length > 0 ? length - (int32_t) headLength : -1;
+  uint8_t byte;
+  // optional header fields
+  if (flags & GZIP_FEXTRA) {
+    uint8_t extra[2];
+    if (readChunk(stream, extra, 2, remaining) != 2) return false;
+    uint16_t extraLength = extra[0] | (extra[1] << 8);
+    for (uint16_t i = 0; i < extraLength; i++) readChunk(stream, &byte, 1, remaining);
+    stats.bytesReceived += 2 + extraLength;
+    if (remaining > 0) remaining -= 2 + extraLength;
+  }
+  for (uint8_t field : {GZIP_FNAME, GZIP_FCOMMENT}) {
+    if (!(flags & field)) continue;
+    do {
+      if (readChunk(stream, &byte, 1, remaining) != 1) return false;
+      stats.bytesReceived++;
+      if (remaining > 0) remaining--;
+    } while (byte != 0);
+  }
+  if (flags & GZIP_FHCRC) {
+    uint8_t crc[2];
+    readChunk(stream, crc, 2, remaining);
+    stats.bytesReceived += 2;
+    if (remaining > 0) remaining -= 2;
+  }
+
+  auto *inflator = (tinfl_decompressor *) malloc(sizeof(tinfl_decompressor));
+  auto *dictionary = (uint8_t *) malloc(TINFL_LZ_DICT_SIZE);
+  auto *input = (uint8_t *) malloc(OTA_CHUNK_SIZE);
+  bool ok = inflator != nullptr && dictionary != nullptr && input != nullptr && Update.begin(UPDATE_SIZE_UNKNOWN);
+  if (ok) {
+    tinfl_init(inflator);
+    size_t inputLength = 0;
+    size_t inputOffset = 0;
+    size_t dictionaryOffset = 0;
+    bool endOfInput = false;
+    tinfl_status status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    while (ok) {
+      if (inputOffset == inputLength && !endOfInput && status == TINFL_STATUS_NEEDS_MORE_INPUT) {
+        inputLength = readChunk(stream, input, OTA_CHUNK_SIZE, remaining);
+        inputOffset = 0;
+        endOfInput = inputLength == 0;
+        stats.bytesReceived += inputLength;
+        if (remaining > 0) remaining -= inputLength;
+      }
+      size_t in = inputLength - inputOffset;
+      size_t out = TINFL_LZ_DICT_SIZE - dictionaryOffset;
+      status = tinfl_decompress(inflator, input + inputOffset, &in, dictionary, dictionary + dictionaryOffset, &out,
+                                endOfInput ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+      inputOffset += in;
+      if (out > 0) {
+        ok = Update.write(dictionary + dictionaryOffset, out) == out;
+        stats.bytesWritten += out;
+        dictionaryOffset = (dictionaryOffset + out) & (TINFL_LZ_DICT_SIZE - 1);
+      }
+      progress(stats.bytesReceived, length > 0 ? length : 0);
+      if (status == TINFL_STATUS_DONE) break;
+      if (status < TINFL_STATUS_DONE || (endOfInput && status == TINFL_STATUS_NEEDS_MORE_INPUT)) ok = false;
+    }
+    // the gzip trailer (CRC32 and size) is not needed, the image is verified by Update.end()
+    ok = ok && Update.end(true);
+  }
+  free(input);
+  free(dictionary);
+  free(inflator);
+  return ok;
+}
+#endif
+
+// patch received from the download, old image read from the running firmware, new image written by Update
+class FlashPatch : public DeltaPatch {
+
+private:
+    Stream &stream;
+    int32_t remaining;
+    uint32_t &received;
+    uint32_t &flashed;
+
+protected:
+    size_t readPatch(uint8_t *buffer, size_t size) override {
+      size_t read = readChunk(stream, buffer, size, remaining);
+      received += read;
+      if (remaining > 0) remaining -= read;
+      return read;
+    }
+
+    bool readOld(uint32_t offset, uint8_t *data, size_t size) override {
+#if defined(ESP8266)
+      // the sketch is at the start of the flash, eboot included
+      return ESP.flashRead(offset, data, size);
+#elif defined(ARDUINO_ARCH_ESP32)
+      return esp_partition_read(esp_ota_get_running_partition(), offset, data, size) == ESP_OK;
+#endif
+    }
+
+    bool writeNew(const uint8_t *data, size_t size) override {
+      flashed += size;
+      return Update.write((uint8_t *) data, size) == size;
+    }
+
+    void progress(uint32_t done, uint32_t total) override {
+      OtaManager::progress(done, total);
+    }
+
+public:
+    FlashPatch(Stream &s, int32_t length, uint32_t &receivedBytes, uint32_t &flashedBytes)
+        : stream(s), remaining(length), received(receivedBytes), flashed(flashedBytes) {}
+};
+
+static void toHex(const uint8_t *md5, char *hex) {
+  for (uint8_t i = 0; i < 16; i++) sprintf(hex + i * 2, "%02x", md5[i]);
+}
+
+bool OtaManager::applyPatch(Stream &stream, int32_t length, const uint8_t *head, size_t headLength) {
+  uint8_t header[DELTA_PATCH_HEADER];
+  memcpy(header, head, headLength);
+  int32_t remaining = length > 0 ? length - (int32_t) headLength : -1;
+  size_t read = readChunk(stream, header + headLength, sizeof(header) - headLength, remaining);
+  if (headLength + read != sizeof(header)) return false;
+  stats.bytesReceived += read;
+  if (remaining > 0) remaining -= read;
+
+  DeltaPatchHeader patchHeader;
+  if (!DeltaPatch::parseHeader(header, patchHeader)) return false;
+  char oldMd5[33];
+  char newMd5[33];
+  toHex(patchHeader.oldMd5, oldMd5);
+  toHex(patchHeader.newMd5, newMd5);
+  if (patchHeader.oldSize != ESP.getSketchSize() || !ESP.getSketchMD5().equals(oldMd5)) {
+    LOG_E("OTA", "The patch is not made for the running firmware");
+    return false;
+  }
+  if (!Update.begin(patchHeader.newSize) || !Update.setMD5(newMd5)) return false;
+
+  FlashPatch patch(stream, remaining, stats.bytesReceived, stats.bytesWritten);
+  // Update.end() checks the MD5 of the new image
+  return patch.apply(patchHeader) && Update.end();
+}
+
+const OtaStats &OtaManager::getStats() {
+  return stats;
+}
@@ -0,0 +1,67 @@
+/*
+  OtaManager.h - Compressed firmware updates
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_OTA_MANAGER_H
+#define _DPSOFTWARE_OTA_MANAGER_H
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+struct OtaStats {
+    uint32_t bytesReceived; // bytes on air
+    uint32_t bytesWritten; // firmware bytes written to flash, decompressed on ESP32
+    uint32_t durationMs;
+    bool compressed;
+    bool patch;
+    bool success;
+};
+
+/*
+  Firmware updates pulled over HTTP or HTTPS (verified with /ota_ca.pem in LittleFS), plain or gzip compressed (gzip -9 firmware.bin), the format is detected from the first bytes.
+  ESP8266 writes the compressed image as it is, the bootloader decompresses it while copying it in place.
+  ESP32 inflates the image while it is received and writes the firmware to the OTA partition, no temporary copy is stored.
+  Delta patches made by tools/delta_ota.py against the running firmware are applied while they are received,
+  the running image and the patched one are verified with their MD5.
+  Progress is printed every OTA_PROGRESS_STEP percent, the stats of the last update compare bytes on air and firmware size.
+*/
+class OtaManager {
+
+private:
+    static OtaStats stats;
+    static uint8_t lastProgress;
+
+    static bool writeStream(Stream &stream, int32_t length);
+
+    static bool applyPatch(Stream &stream, int32_t length, const uint8_t *head, size_t headLength);
+
+#if defined(ARDUINO_ARCH_ESP32) && (OTA_GZIP)
+    static bool inflateStream(Stream &stream, int32_t length, const uint8_t *head, size_t headLength);
+#endif
+
+public:
+    static bool updateFromUrl(const char *url); // download and write the firmware or a patch, restart to apply it
+
+    static void resetProgress(); // at the start of an update
+
+    static void progress(uint32_t done, uint32_t total); // rate limited progress, feeds the watchdog
+
+    static const OtaStats &getStats();
+};
+
+#endif
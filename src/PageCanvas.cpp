@@ -0,0 +1,58 @@
+/*
+  PageCanvas.cpp - Off screen canvas with the SSD1306 memory layout
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "PageCanvas.h"
+
+#if (DISPLAY_ENABLED)
+
+void PageCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+  uint8_t &page = buffer[x + (y / 8) * WIDTH];
+  switch (color) {
+    case SSD1306_WHITE: page |= (1 << (y & 7)); break;
+    case SSD1306_BLACK: page &= ~(1 << (y & 7)); break;
+    case SSD1306_INVERSE: page ^= (1 << (y & 7)); break;
+    default: break;
+  }
+}
+
+void PageCanvas::fillScreen(uint16_t color) {
+  memset(buffer, color ? 0xFF : 0x00, WIDTH * (HEIGHT / 8));
+}
+
+void PageCanvas::blitTo(uint8_t *framebuffer, int16_t framebufferHeight, int16_t y) const {
+  int16_t canvasPages = HEIGHT / 8;
+  for (int16_t destPage = 0; destPage < framebufferHeight / 8; destPage++) {
+    // canvas rows shown in this framebuffer page, they can span two canvas pages
+    int16_t srcY = destPage * 8 - y;
+    if (srcY <= -8 || srcY >= HEIGHT) continue;
+    int16_t srcPage = srcY >= 0 ? srcY / 8 : -1;
+    uint8_t shift = srcY & 7;
+    const uint8_t *upper = srcPage >= 0 ? buffer + srcPage * WIDTH : nullptr;
+    const uint8_t *lower = shift != 0 && srcPage + 1 < canvasPages ? buffer + (srcPage + 1) * WIDTH : nullptr;
+    uint8_t *dest = framebuffer + destPage * WIDTH;
+    for (int16_t x = 0; x < WIDTH; x++) {
+      uint8_t bits = upper != nullptr ? upper[x] >> shift : 0;
+      if (lower != nullptr) bits |= lower[x] << (8 - shift);
+      dest[x] |= bits;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+  PageCanvas.h - Off screen canvas with the SSD1306 memory layout
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_PAGE_CANVAS_H
+#define _DPSOFTWARE_PAGE_CANVAS_H
+
+#include "Configuration.h"
+
+#if (DISPLAY_ENABLED)
+
+/*
+  1 bit canvas stored in pages of 8 vertical pixels like the SSD1306 framebuffer,
+  so that it can be copied into the framebuffer at any vertical offset with byte operations
+  instead of drawing it pixel by pixel. Height must be a multiple of 8.
+*/
+class PageCanvas : public Adafruit_GFX {
+
+private:
+    uint8_t *buffer;
+
+public:
+    PageCanvas(int16_t w, int16_t h, uint8_t *canvasBuffer) : Adafruit_GFX(w, h), buffer(canvasBuffer) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+
+    void fillScreen(uint16_t color) override;
+
+    // OR the canvas into a framebuffer with the same width, the canvas top is drawn at y
+    void blitTo(uint8_t *framebuffer, int16_t framebufferHeight, int16_t y) const;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,243 @@
+/*
+  PingService.cpp - Non blocking ICMP probes with RTT statistics
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "PingService.h"
+#if defined(ESP8266)
+#include <ESP8266WiFi.h>
+extern "C" {
+#include <ping.h>
+}
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <ETH.h>
+#include "ping/ping_sock.h"
+#include "LinkManager.h"
+#endif
+#include "Helpers.h"
+#include "TaskScheduler.h"
+#include "BrokerManager.h"
+#include "QueueManager.h"
+
+#define PING_LOST 0xFFFF
+
+// the result of a probe is collected when the next one is sent
+static_assert(PING_INTERVAL == 0 || PING_INTERVAL > PING_TIMEOUT, "PING_INTERVAL must be greater than PING_TIMEOUT");
+
+enum PingProbeState {
+    Probe_Idle,
+    Probe_Sent,
+    Probe_Replied,
+    Probe_Lost
+};
+
+PingService::Target PingService::targets[PING_MAX_TARGETS];
+uint8_t PingService::targetCount = 0;
+int8_t PingService::probeTarget = -1;
+volatile uint8_t PingService::probeState = Probe_Idle;
+volatile uint32_t PingService::probeRtt = 0;
+
+#if defined(ESP8266)
+static ping_option pingOptions;
+
+// called by the core when the echo reply arrives or times out
+static void pingReceived(void *opt, void *resp) {
+  auto *pingResp = reinterpret_cast<struct ping_resp *>(resp);
+  PingService::onResult(pingResp->ping_err != -1, pingResp->resp_time);
+}
+#elif defined(ARDUINO_ARCH_ESP32)
+static esp_ping_handle_t pingSession = nullptr;
+
+// called by the esp_ping task
+static void pingSuccess(esp_ping_handle_t session, void *args) {
+  uint32_t elapsed;
+  esp_ping_get_profile(session, ESP_PING_PROF_TIMEGAP, &elapsed, sizeof(elapsed));
+  PingService::onResult(true, elapsed);
+}
+
+static void pingTimeout(esp_ping_handle_t session, void *args) {
+  PingService::onResult(false, 0);
+}
+#endif
+
+void PingService::onResult(bool replied, uint32_t rtt) {
+  probeRtt = rtt;
+  probeState = replied ? Probe_Replied : Probe_Lost;
+}
+
+void PingService::begin() {
+  targetCount = 0;
+  probeTarget = -1;
+  probeState = Probe_Idle;
+  addTarget(IPAddress(0, 0, 0, 0));
+  targets[0].gateway = true;
+  // the address of the active broker is read before every probe, it follows hostnames and failovers
+  int8_t broker = addTarget(IPAddress(0, 0, 0, 0));
+  if (broker >= 0) targets[broker].broker = true;
+  // collect() feeds LinkManager, that runs in the network task
+  TaskScheduler::every(PING_INTERVAL, []() { QueueManager::runOnNetworkTask(probe); });
+}
+
+int8_t PingService::addTarget(const IPAddress &ip) {
+  if (targetCount >= PING_MAX_TARGETS) {
+    return -1;
+  }
+  Target &target = targets[targetCount];
+  target = {};
+  target.ip = ip;
+  return (int8_t) targetCount++;
+}
+
+uint8_t PingService::getTargetCount() {
+  return targetCount;
+}
+
+void PingService::record(Target &target, uint16_t rtt) {
+  target.rtt[target.next] = rtt;
+  target.next = (target.next + 1) % PING_WINDOW;
+  if (target.samples < PING_WINDOW) target.samples++;
+}
+
+// the result of the probe in flight, a probe without an answer by now is lost
+void PingService::collect() {
+  if (probeTarget < 0) return;
+  uint8_t state = probeState;
+  if (state == Probe_Replied) {
+    uint32_t rtt = probeRtt;
+    record(targets[probeTarget], rtt < PING_LOST ? rtt : PING_LOST - 1);
+  } else {
+    record(targets[probeTarget], PING_LOST);
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  if (pingSession != nullptr) {
+    esp_ping_stop(pingSession);
+    esp_ping_delete_session(pingSession);
+    pingSession = nullptr;
+  }
+  // pings go through the default interface, that is the active link
+  if (ethd > 0 && probeTarget == 0) {
+    LinkManager::reportPacketLoss(LinkManager::getActiveLink(), state == Probe_Replied ? 0 : 100);
+  }
+#endif
+  probeTarget = -1;
+  probeState = Probe_Idle;
+}
+
+void PingService::probe() {
+  collect();
+  bool networkUp = WiFi.status() == WL_CONNECTED || ethConnected;
+  if (targetCount == 0 || !networkUp) return;
+  static uint8_t nextTarget = 0;
+  uint8_t index = nextTarget;
+  nextTarget = (nextTarget + 1) % targetCount;
+  Target &target = targets[index];
+  if (target.gateway) {
+#if defined(ARDUINO_ARCH_ESP32)
+    target.ip = ethConnected && LinkManager::getActiveLink() == Link_Ethernet ? ETH.gatewayIP() : WiFi.gatewayIP();
+#else
+    target.ip = WiFi.gatewayIP();
+#endif
+  } else if (target.broker) {
+    IPAddress broker = BrokerManager::getActiveIp();
+    if (broker != target.ip) {
+      // samples of the previous broker don't describe the new one
+      target.samples = 0;
+      target.next = 0;
+      target.ip = broker;
+    }
+  }
+  if (target.ip == IPAddress(0, 0, 0, 0)) return;
+  probeTarget = (int8_t) index;
+  probeState = Probe_Sent;
+  if (!send(target.ip)) {
+    probeState = Probe_Lost;
+  }
+}
+
+bool PingService::send(const IPAddress &ip) {
+#if defined(ESP8266)
+  memset(&pingOptions, 0, sizeof(struct ping_option));
+  pingOptions.count = 1;
+  pingOptions.coarse_time = 1;
+  pingOptions.ip = ip;
+  pingOptions.recv_function = reinterpret_cast<ping_recv_function>(&pingReceived);
+  pingOptions.sent_function = nullptr;
+  return ping_start(&pingOptions);
+#elif defined(ARDUINO_ARCH_ESP32)
+  esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+  IP_ADDR4(&config.target_addr, ip[0], ip[1], ip[2], ip[3]);
+  config.count = 1;
+  config.timeout_ms = PING_TIMEOUT;
+  esp_ping_callbacks_t callbacks = {};
+  callbacks.on_ping_success = pingSuccess;
+  callbacks.on_ping_timeout = pingTimeout;
+  if (esp_ping_new_session(&config, &callbacks, &pingSession) != ESP_OK) {
+    pingSession = nullptr;
+    return false;
+  }
+  return esp_ping_start(pingSession) == ESP_OK;
+#endif
+}
+
+PingStats PingService::getStats(uint8_t index) {
+  PingStats stats = {};
+  if (index >= targetCount) return stats;
+  const Target &target = targets[index];
+  stats.ip = target.ip;
+  stats.samples = target.samples;
+  uint32_t sum = 0;
+  uint32_t jitterSum = 0;
+  uint8_t replies = 0;
+  uint8_t jitterSamples = 0;
+  uint16_t previous = PING_LOST;
+  // oldest to newest, the jitter is computed between consecutive replies
+  for (uint8_t i = 0; i < target.samples; i++) {
+    uint16_t rtt = target.rtt[(target.next + PING_WINDOW - target.samples + i) % PING_WINDOW];
+    if (rtt == PING_LOST) {
+      stats.lost++;
+      continue;
+    }
+    if (replies == 0 || rtt < stats.min) stats.min = rtt;
+    if (rtt > stats.max) stats.max = rtt;
+    sum += rtt;
+    replies++;
+    if (previous != PING_LOST) {
+      jitterSum += rtt > previous ? rtt - previous : previous - rtt;
+      jitterSamples++;
+    }
+    previous = rtt;
+  }
+  if (replies > 0) stats.avg = sum / replies;
+  if (jitterSamples > 0) stats.jitter = jitterSum / jitterSamples;
+  if (stats.samples > 0) stats.loss = stats.lost * 100 / stats.samples;
+  return stats;
+}
+
+void PingService::addTo(JsonObject object) {
+  JsonArray array = object["ping"].to<JsonArray>();
+  for (uint8_t i = 0; i < targetCount; i++) {
+    PingStats stats = getStats(i);
+    JsonObject item = array.add<JsonObject>();
+    item["ip"] = stats.ip.toString();
+    item["min"] = stats.min;
+    item["avg"] = stats.avg;
+    item["max"] = stats.max;
+    item["jitter"] = stats.jitter;
+    item["loss"] = stats.loss;
+  }
+}
@@ -0,0 +1,85 @@
+/*
+  PingService.h - Non blocking ICMP probes with RTT statistics
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_PING_SERVICE_H
+#define _DPSOFTWARE_PING_SERVICE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <IPAddress.h>
+#include "Configuration.h"
+
+struct PingStats {
+    IPAddress ip; // 0.0.0.0 for the gateway and broker targets before the first probe
+    uint8_t samples; // probes in the window
+    uint8_t lost;
+    uint8_t loss; // percentage of lost probes in the window
+    uint16_t min; // round trip time in milliseconds, 0 when no reply in the window
+    uint16_t avg;
+    uint16_t max;
+    uint16_t jitter; // mean difference between consecutive round trip times
+};
+
+/*
+  Sends one ICMP echo every PING_INTERVAL milliseconds from the task scheduler, to one target at a time in turn,
+  and keeps the last PING_WINDOW results of every target. The echo is sent with the asynchronous ping of the core
+  (ping_start() on ESP8266, esp_ping sessions on ESP32), its result is collected by the next probe so the loop never waits.
+  The default targets are the gateway, that keeps the WiFi association alive, and the MQTT broker.
+*/
+class PingService {
+
+private:
+    struct Target {
+        IPAddress ip;
+        bool gateway; // the ip is read again before every probe
+        bool broker; // the ip of the active MQTT broker, read again before every probe
+        uint16_t rtt[PING_WINDOW];
+        uint8_t samples;
+        uint8_t next;
+    };
+
+    static Target targets[PING_MAX_TARGETS];
+    static uint8_t targetCount;
+    static int8_t probeTarget; // target of the probe in flight, -1 when idle
+    static volatile uint8_t probeState;
+    static volatile uint32_t probeRtt;
+
+    static void probe(); // collect the last result and send the next echo, called by the scheduler
+
+    static void collect();
+
+    static bool send(const IPAddress &ip);
+
+    static void record(Target &target, uint16_t rtt);
+
+public:
+    static void onResult(bool replied, uint32_t rtt); // called by the ping callbacks of the core
+
+    static void begin(); // add the gateway and the broker, start probing
+
+    static int8_t addTarget(const IPAddress &ip); // returns the target index or -1
+
+    static uint8_t getTargetCount();
+
+    static PingStats getStats(uint8_t target);
+
+    static void addTo(JsonObject object); // ping stats for the state message
+};
+
+#endif
@@ -18,17 +18,44 @@
 */
 
 #include "QueueManager.h"
+#include "DisplayManager.h"
+#include "BrokerManager.h"
+#include "MqttTls.h"
 
 
+#if (MQTT_TLS)
+PubSubClient mqttClient(MqttTls::getClient());
+#else
 PubSubClient mqttClient(espClient);
+#endif
+uint32_t QueueManager::publishFailures = 0;
+#if (INBOUND_QUEUE_ACTIVE)
+SpscQueue<QueueMessage, MESSAGE_QUEUE_SIZE> QueueManager::inboundQueue;
+void (*QueueManager::userCallback)(char *, byte *, unsigned int) = nullptr;
+InboundQueueStats QueueManager::inboundStats = {};
+#endif
+#if (NETWORK_TASK_ACTIVE)
+TaskHandle_t QueueManager::networkTask = nullptr;
+SpscQueue<QueueMessage, MESSAGE_QUEUE_SIZE> QueueManager::outboundQueue;
+uint32_t QueueManager::outboundDropped = 0;
+SpscQueue<void (*)(), NETWORK_ACTION_QUEUE_SIZE> QueueManager::networkActions;
+SpscQueue<void (*)(), NETWORK_ACTION_QUEUE_SIZE> QueueManager::applicationActions;
+#endif
+int QueueManager::shownAttempt = 0;
 
 /********************************** SETUP MQTT QUEUE **********************************/
 void QueueManager::setupMQTTQueue(void (*callback)(char *, byte *, unsigned int)) {
-  mqttClient.setServer(IPAddress(Helpers::getValue(mqttIP, '.', 0).toInt(),
-                                 Helpers::getValue(mqttIP, '.', 1).toInt(),
-                                 Helpers::getValue(mqttIP, '.', 2).toInt(),
-                                 Helpers::getValue(mqttIP, '.', 3).toInt()), mqttPort.toInt());
+#if (MQTT_TLS)
+  MqttTls::begin();
+#endif
+  BrokerManager::begin(mqttClient);
+#if (INBOUND_QUEUE_ACTIVE)
+  // messages are queued by the MQTT client and delivered to the callback by bootstrapLoop()
+  userCallback = callback;
+  mqttClient.setCallback(enqueueInbound);
+#else
   mqttClient.setCallback(callback);
+#endif
   mqttClient.setBufferSize(MQTT_MAX_PACKET_SIZE);
   mqttClient.setKeepAlive(MQTT_KEEP_ALIVE);
 }
@@ -48,31 +75,19 @@ void QueueManager::mqttReconnect(void (*manageDisconnections)(), void (*manageQu
                                  void (*manageHardwareButton)()) {
   // Loop until we're reconnected
   while ((WiFi.status() == WL_CONNECTED || (ethd >= 0 && ethConnected)) && !mqttClient.connected() && Serial.peek() == -1) {
-#if (DISPLAY_ENABLED)
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setCursor(0,0);
-#endif
-    if (mqttReconnectAttemp <= 20) {
-      Helpers::smartPrintln(F("Connecting to"));
-      Helpers::smartPrintln(F("MQTT Broker..."));
-    }
-    helper.smartDisplay();
+    shownAttempt = mqttReconnectAttemp;
+    runOnApplicationTask(showConnecting);
     // Manage hardware button if any
     manageHardwareButton();
     // Attempt to connect to MQTT server with QoS = 1 (pubsubclient supports QoS 1 for subscribe only, published msg have QoS 0 this is why I implemented a custom solution)
     boolean mqttSuccess;
-    Serial.println("MQTT Last Will Params: ");
-    Serial.print("willTopic: ");
-    Serial.println(mqttWillTopic);
-    Serial.print("willPayload: ");
-    Serial.println(mqttWillPayload);
-    Serial.print("qos: ");
-    Serial.println(mqttWillQOS);
-    Serial.print("retain: ");
-    Serial.println(mqttWillRetain);
-    Serial.print("clean session: ");
-    Serial.println(mqttCleanSession);
+    BrokerManager::beforeConnect(mqttClient);
+#if (MQTT_TLS)
+    MqttTls::beforeConnect(BrokerManager::getActiveHost(), BrokerManager::getActivePort());
+#endif
+    unsigned long connectStart = millis();
+    LOG_D("MQTT", "Last will topic: %s, payload: %s, qos: %d, retain: %d, clean session: %d",
+          mqttWillTopic.c_str(), mqttWillPayload.c_str(), mqttWillQOS, mqttWillRetain, mqttCleanSession);
     if (mqttuser.isEmpty() || mqttpass.isEmpty()) {
       mqttSuccess = mqttClient.connect(deviceName.c_str(), mqttWillTopic.c_str(),
                                        mqttWillQOS, mqttWillRetain, mqttWillPayload.c_str());
@@ -81,13 +96,12 @@ void QueueManager::mqttReconnect(void (*manageDisconnections)(), void (*manageQu
                                        mqttpass.c_str(), mqttWillTopic.c_str(), mqttWillQOS,
                                        mqttWillRetain, mqttWillPayload.c_str(), mqttCleanSession);
     }
+#if (MQTT_TLS)
+    MqttTls::connectResult(millis() - connectStart, mqttSuccess);
+#endif
+    BrokerManager::connectResult(mqttClient, mqttSuccess);
     if (mqttSuccess) {
-      Helpers::smartPrintln(F(""));
-      Helpers::smartPrintln(F("MQTT CONNECTED"));
-      Helpers::smartPrintln(F(""));
-      Helpers::smartPrintln(F("Reading data from"));
-      Helpers::smartPrintln(F("the network..."));
-      helper.smartDisplay();
+      runOnApplicationTask(showConnected);
       // Subscribe to MQTT topics
       manageQueueSubscription();
       delay(DELAY_2000);
@@ -95,18 +109,15 @@ void QueueManager::mqttReconnect(void (*manageDisconnections)(), void (*manageQu
       // reset the lastMQTTConnection to off, will be initialized by next time update
       lastMQTTConnection = OFF_CMD;
     } else {
-      Helpers::smartPrintln(F("MQTT attempts="));
 #if defined(ESP8266)
       ESP.wdtFeed();
 #else
       esp_task_wdt_reset();
 #endif
-      Helpers::smartPrintln(mqttReconnectAttemp);
-      helper.smartDisplay();
+      runOnApplicationTask(showAttempt);
       // after MAX_RECONNECT attemps all peripherals are shut down
       if (mqttReconnectAttemp >= MAX_RECONNECT || fastDisconnectionManagement) {
-        Helpers::smartPrintln(F("Max retry reached, powering off peripherals."));
-        helper.smartDisplay();
+        runOnApplicationTask(showMaxRetry);
         // Manage disconnections, powering off peripherals
         manageDisconnections();
       } else if (mqttReconnectAttemp > 10000) {
@@ -125,37 +136,285 @@ void QueueManager::mqttReconnect(void (*manageDisconnections)(), void (*manageQu
   }
 }
 
+// the display is drawn by the loop task only, the frames are sent before the reconnection waits
+void QueueManager::showConnecting() {
+#if (DISPLAY_ENABLED)
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setCursor(0,0);
+#endif
+  if (shownAttempt <= 20) {
+    Helpers::smartPrintln(F("Connecting to"));
+    Helpers::smartPrintln(F("MQTT Broker..."));
+  }
+  Helpers helper;
+  helper.smartDisplay();
+}
+
+void QueueManager::showConnected() {
+  Helpers::smartPrintln(F(""));
+  Helpers::smartPrintln(F("MQTT CONNECTED"));
+  Helpers::smartPrintln(F(""));
+  Helpers::smartPrintln(F("Reading data from"));
+  Helpers::smartPrintln(F("the network..."));
+  Helpers helper;
+  helper.smartDisplay();
+  DisplayManager::flush();
+}
+
+void QueueManager::showAttempt() {
+  Helpers::smartPrintln(F("MQTT attempts="));
+  Helpers::smartPrintln(shownAttempt);
+  Helpers helper;
+  helper.smartDisplay();
+  DisplayManager::flush();
+}
+
+void QueueManager::showMaxRetry() {
+  Helpers::smartPrintln(F("Max retry reached, powering off peripherals."));
+  Helpers helper;
+  helper.smartDisplay();
+  DisplayManager::flush();
+}
+
 void QueueManager::queueLoop(void (*manageDisconnections)(), void (*manageQueueSubscription)(),
                              void (*manageHardwareButton)()) {
   if (!mqttClient.connected()) {
     mqttConnected = false;
+    BrokerManager::connectionLost();
     mqttReconnect(manageDisconnections, manageQueueSubscription, manageHardwareButton);
   } else {
     mqttConnected = true;
+    BrokerManager::loop(mqttClient);
   }
   mqttClient.loop();
 }
 
 /********************************** SEND A MESSAGE ON THE QUEUE **********************************/
 void QueueManager::publish(const char *topic, const char *payload, boolean retained) {
-  mqttClient.publish(topic, payload, retained);
+#if (NETWORK_TASK_ACTIVE)
+  if (isApplicationTask()) {
+    enqueueOutbound(Msg_Publish, topic, payload, strlen(payload), retained, 0);
+    return;
+  }
+#endif
+  if (!mqttClient.publish(topic, payload, retained)) {
+    publishFailures++;
+  }
 }
 
 /********************************** SUBSCRIBE TO A QUEUE TOPIC **********************************/
 void QueueManager::unsubscribe(const char *topic) {
+#if (NETWORK_TASK_ACTIVE)
+  if (isApplicationTask()) {
+    enqueueOutbound(Msg_Unsubscribe, topic, "", 0, false, 0);
+    return;
+  }
+#endif
   mqttClient.unsubscribe(topic);
 }
 
 /********************************** SUBSCRIBE TO A QUEUE TOPIC **********************************/
 void QueueManager::subscribe(const char *topic) {
-  mqttClient.subscribe(topic);
+  subscribe(topic, 0);
 }
 
 /********************************** SUBSCRIBE TO A QUEUE TOPIC **********************************/
 void QueueManager::subscribe(const char *topic, uint8_t qos) {
+#if (NETWORK_TASK_ACTIVE)
+  if (isApplicationTask()) {
+    enqueueOutbound(Msg_Subscribe, topic, "", 0, false, qos);
+    return;
+  }
+#endif
   mqttClient.subscribe(topic, qos);
 }
 
 PubSubClient& QueueManager::getMqttClient() {
   return mqttClient;
 }
+
+uint32_t QueueManager::getPublishFailures() {
+  return publishFailures;
+}
+
+// the network task owns WiFi and the link state, actions from the scheduler of the loop task run there
+void QueueManager::runOnNetworkTask(void (*action)()) {
+#if (NETWORK_TASK_ACTIVE)
+  if (isApplicationTask()) {
+    void (**slot)() = networkActions.acquire();
+    // periodic actions are posted again on the next run
+    if (slot == nullptr) return;
+    *slot = action;
+    networkActions.commit();
+    return;
+  }
+#endif
+  action();
+}
+
+void QueueManager::runOnApplicationTask(void (*action)()) {
+#if (NETWORK_TASK_ACTIVE)
+  if (isNetworkTask()) {
+    void (**slot)() = applicationActions.acquire();
+    // display output only, the next message replaces a dropped one
+    if (slot == nullptr) return;
+    *slot = action;
+    applicationActions.commit();
+    return;
+  }
+#endif
+  action();
+}
+
+#if (NETWORK_TASK_ACTIVE)
+/********************************** MESSAGE QUEUES SHARED WITH THE NETWORK TASK **********************************/
+void QueueManager::setNetworkTask(TaskHandle_t task) {
+  networkTask = task;
+}
+
+bool QueueManager::isApplicationTask() {
+  return networkTask != nullptr && xTaskGetCurrentTaskHandle() != networkTask;
+}
+
+bool QueueManager::isNetworkTask() {
+  return networkTask != nullptr && xTaskGetCurrentTaskHandle() == networkTask;
+}
+
+bool QueueManager::enqueueOutbound(uint8_t type, const char *topic, const char *payload, size_t length, boolean retained, uint8_t qos) {
+  QueueMessage *msg = outboundQueue.acquire();
+  size_t topicLength = strlen(topic);
+  if (msg == nullptr || topicLength >= MESSAGE_QUEUE_TOPIC_SIZE || length > MESSAGE_QUEUE_PAYLOAD_SIZE) {
+    outboundDropped++;
+    return false;
+  }
+  msg->type = type;
+  msg->qos = qos;
+  msg->retained = retained;
+  memcpy(msg->topic, topic, topicLength + 1);
+  memcpy(msg->payload, payload, length);
+  msg->payload[length] = '\0';
+  msg->length = length;
+  outboundQueue.commit();
+  return true;
+}
+
+// messages stay in the queue while the broker is not connected
+void QueueManager::processOutbound() {
+  QueueMessage *msg;
+  while (mqttClient.connected() && (msg = outboundQueue.peek()) != nullptr) {
+    switch (msg->type) {
+      case Msg_Publish:
+        if (!mqttClient.publish(msg->topic, (const uint8_t *) msg->payload, msg->length, msg->retained)) {
+          publishFailures++;
+        }
+        break;
+      case Msg_Subscribe:
+        mqttClient.subscribe(msg->topic, msg->qos);
+        break;
+      case Msg_Unsubscribe:
+        mqttClient.unsubscribe(msg->topic);
+        break;
+      default:
+        break;
+    }
+    outboundQueue.release();
+  }
+}
+
+void QueueManager::processNetworkActions() {
+  void (**slot)();
+  while ((slot = networkActions.peek()) != nullptr) {
+    void (*action)() = *slot;
+    networkActions.release();
+    action();
+  }
+}
+
+void QueueManager::processApplicationActions() {
+  void (**slot)();
+  while ((slot = applicationActions.peek()) != nullptr) {
+    void (*action)() = *slot;
+    applicationActions.release();
+    action();
+  }
+}
+
+uint32_t QueueManager::getOutboundDropped() {
+  return outboundDropped;
+}
+#endif
+
+#if (INBOUND_QUEUE_ACTIVE)
+/********************************** INBOUND MESSAGE QUEUE **********************************/
+// free slot for a received message, applying INBOUND_QUEUE_POLICY when the queue is full
+QueueMessage *QueueManager::acquireInboundSlot() {
+  QueueMessage *msg = inboundQueue.acquire();
+#if (NETWORK_TASK_ACTIVE) && (INBOUND_QUEUE_POLICY == 2)
+  // slowing down the network task slows down the broker too
+  unsigned long waitStart = millis();
+  while (msg == nullptr && millis() - waitStart < INBOUND_QUEUE_BLOCK_TIMEOUT) {
+    vTaskDelay(1);
+    msg = inboundQueue.acquire();
+  }
+#elif !(NETWORK_TASK_ACTIVE) && (INBOUND_QUEUE_POLICY == 1)
+  // producer and consumer share the same task, the oldest message can be freed here
+  if (msg == nullptr) {
+    inboundQueue.release();
+    inboundStats.droppedFull++;
+    msg = inboundQueue.acquire();
+  }
+#endif
+  return msg;
+}
+
+// PubSubClient callback, the payload is valid only during the call so it is copied into a preallocated slot
+void QueueManager::enqueueInbound(char *topic, byte *payload, unsigned int length) {
+  inboundStats.received++;
+  size_t topicLength = strlen(topic);
+  if (topicLength >= MESSAGE_QUEUE_TOPIC_SIZE || length > MESSAGE_QUEUE_PAYLOAD_SIZE) {
+    inboundStats.droppedTooBig++;
+    return;
+  }
+  QueueMessage *msg = acquireInboundSlot();
+  if (msg == nullptr) {
+    inboundStats.droppedFull++;
+    return;
+  }
+  msg->type = Msg_Received;
+  memcpy(msg->topic, topic, topicLength + 1);
+  memcpy(msg->payload, payload, length);
+  msg->payload[length] = '\0';
+  msg->length = length;
+  inboundQueue.commit();
+  uint32_t queued = inboundQueue.size();
+  if (queued > inboundStats.highWater) inboundStats.highWater = queued;
+}
+
+uint8_t QueueManager::processInbound(uint8_t maxMessages) {
+  uint8_t delivered = 0;
+  QueueMessage *msg;
+  while ((maxMessages == 0 || delivered < maxMessages) && (msg = inboundQueue.peek()) != nullptr) {
+    if (userCallback != nullptr) {
+      userCallback(msg->topic, (byte *) msg->payload, msg->length);
+    }
+    inboundQueue.release();
+    delivered++;
+  }
+  return delivered;
+}
+
+const QueueMessage *QueueManager::peekInbound() {
+  return inboundQueue.peek();
+}
+
+void QueueManager::releaseInbound() {
+  if (inboundQueue.peek() != nullptr) {
+    inboundQueue.release();
+  }
+}
+
+const InboundQueueStats &QueueManager::getInboundStats() {
+  return inboundStats;
+}
+#endif
@@ -22,12 +22,68 @@
 
 #include <PubSubClient.h>
 #include "WifiManager.h"
+#include "SpscQueue.h"
+#include "Logger.h"
 
+enum QueueMessageType {
+    Msg_Publish,
+    Msg_Subscribe,
+    Msg_Unsubscribe,
+    Msg_Received
+};
+
+// preallocated MQTT message exchanged through the message queues
+struct QueueMessage {
+    uint8_t type;
+    uint8_t qos;
+    bool retained;
+    uint16_t length;
+    char topic[MESSAGE_QUEUE_TOPIC_SIZE];
+    char payload[MESSAGE_QUEUE_PAYLOAD_SIZE + 1];
+};
+
+struct InboundQueueStats {
+    uint32_t received; // messages received from the broker
+    uint32_t droppedFull; // messages dropped because the queue was full
+    uint32_t droppedTooBig; // messages dropped because topic or payload didn't fit a slot
+    uint32_t highWater; // max number of messages waiting in the queue
+};
 
 class QueueManager {
 
 private:
-    Helpers helper;
+    static uint32_t publishFailures;
+#if (INBOUND_QUEUE_ACTIVE)
+    static SpscQueue<QueueMessage, MESSAGE_QUEUE_SIZE> inboundQueue; // MQTT client -> application
+    static void (*userCallback)(char *, byte *, unsigned int);
+    static InboundQueueStats inboundStats;
+
+    static void enqueueInbound(char *topic, byte *payload, unsigned int length);
+
+    static QueueMessage *acquireInboundSlot();
+#endif
+#if (NETWORK_TASK_ACTIVE)
+    static TaskHandle_t networkTask;
+    static SpscQueue<QueueMessage, MESSAGE_QUEUE_SIZE> outboundQueue; // application -> network task
+    static uint32_t outboundDropped;
+    static SpscQueue<void (*)(), NETWORK_ACTION_QUEUE_SIZE> networkActions; // loop task -> network task
+    static SpscQueue<void (*)(), NETWORK_ACTION_QUEUE_SIZE> applicationActions; // network task -> loop task
+
+    static bool enqueueOutbound(uint8_t type, const char *topic, const char *payload, size_t length, boolean retained, uint8_t qos);
+
+    static bool isApplicationTask(); // true when called outside the network task once it is running
+
+    static bool isNetworkTask(); // true when called by the network task
+#endif
+    static int shownAttempt; // attempt drawn by the loop task, the network task keeps counting meanwhile
+
+    static void showConnecting(); // reconnection messages, drawn by the loop task
+
+    static void showConnected();
+
+    static void showAttempt();
+
+    static void showMaxRetry();
 
 public:
     static PubSubClient& getMqttClient();
@@ -39,6 +95,22 @@ public:
     static void unsubscribe(const char *topic); // unsubscribe to a queue topic
     static void subscribe(const char *topic); // subscribe to a queue topic
     static void subscribe(const char *topic, uint8_t qos); // subscribe to a queue topic with qos 0 or 1
+    static uint32_t getPublishFailures(); // messages the client couldn't write to the socket
+    static void runOnNetworkTask(void (*action)()); // WiFi and link actions, posted to the network task when it owns WiFi
+    static void runOnApplicationTask(void (*action)()); // display output, posted to bootstrapLoop() when called by the network task
+#if (INBOUND_QUEUE_ACTIVE)
+    static uint8_t processInbound(uint8_t maxMessages = 0); // deliver the received messages to the callback, 0 delivers all of them
+    static const QueueMessage *peekInbound(); // oldest received message, to drain the queue without the callback
+    static void releaseInbound(); // free the message returned by peekInbound()
+    static const InboundQueueStats &getInboundStats();
+#endif
+#if (NETWORK_TASK_ACTIVE)
+    static void setNetworkTask(TaskHandle_t task); // messages from other tasks are routed through the queues
+    static void processOutbound(); // send the messages queued by the application, called by the network task
+    static void processNetworkActions(); // run the actions posted by runOnNetworkTask(), called by the network task
+    static void processApplicationActions(); // run the actions posted by runOnApplicationTask(), called by bootstrapLoop()
+    static uint32_t getOutboundDropped();
+#endif
 
 };
 
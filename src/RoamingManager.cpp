@@ -0,0 +1,208 @@
+/*
+  RoamingManager.cpp - Multi network WiFi roaming by RSSI
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "RoamingManager.h"
+#include "Helpers.h"
+#include "Logger.h"
+#include "QueueManager.h"
+#include "TaskScheduler.h"
+
+enum RoamingState {
+    Roam_Idle,
+    Roam_Scanning,
+    Roam_Associating,
+    Roam_WaitingMqtt
+};
+
+WifiCredentials RoamingManager::networks[WIFI_MAX_NETWORKS];
+uint8_t RoamingManager::networkCount = 0;
+uint8_t RoamingManager::nextNetwork = 0;
+uint8_t RoamingManager::state = Roam_Idle;
+unsigned long RoamingManager::checkedAt = 0;
+unsigned long RoamingManager::roamStart = 0;
+unsigned long RoamingManager::lastRoam = 0;
+RoamingStats RoamingManager::stats = {};
+
+void RoamingManager::begin() {
+  if (networkCount == 0) {
+    addNetwork(qsid.c_str(), qpass.c_str());
+  }
+  state = Roam_Idle;
+  checkedAt = millis();
+#if (ROAMING_CHECK_INTERVAL > 0)
+  // scans and associations run where WiFi is managed
+  TaskScheduler::every(ROAMING_POLL_INTERVAL, []() { QueueManager::runOnNetworkTask(poll); });
+#endif
+}
+
+void RoamingManager::clearNetworks() {
+  networkCount = 0;
+  nextNetwork = 0;
+}
+
+bool RoamingManager::addNetwork(const char *ssid, const char *pass) {
+  if (networkCount >= WIFI_MAX_NETWORKS || ssid == nullptr || ssid[0] == '\0') {
+    return false;
+  }
+  networks[networkCount].ssid = ssid;
+  networks[networkCount].pass = pass != nullptr ? pass : "";
+  networkCount++;
+  return true;
+}
+
+void RoamingManager::addNetworks(JsonArrayConst list) {
+  for (JsonObjectConst network : list) {
+    const char *ssid = network[F("qsid")];
+    if (ssid != nullptr && findNetwork(ssid) < 0) {
+      addNetwork(ssid, network[F("qpass")]);
+    }
+  }
+}
+
+uint8_t RoamingManager::getNetworkCount() {
+  return networkCount;
+}
+
+int8_t RoamingManager::findNetwork(const String &ssid) {
+  for (uint8_t i = 0; i < networkCount; i++) {
+    if (networks[i].ssid == ssid) return (int8_t) i;
+  }
+  return -1;
+}
+
+bool RoamingManager::requestScan() {
+#if (ROAMING_CHECK_INTERVAL > 0)
+  if (state != Roam_Idle || WiFi.status() != WL_CONNECTED || networkCount == 0) {
+    return false;
+  }
+  if (WiFi.scanNetworks(true) != WIFI_SCAN_RUNNING) {
+    return false;
+  }
+  stats.scans++;
+  state = Roam_Scanning;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void RoamingManager::poll() {
+  unsigned long now = millis();
+  switch (state) {
+    case Roam_Idle:
+      if (now - checkedAt < ROAMING_CHECK_INTERVAL) return;
+      checkedAt = now;
+      if (stats.roams > 0 && now - lastRoam < ROAMING_COOLDOWN) return;
+      if (WiFi.status() == WL_CONNECTED && WiFi.RSSI() < ROAMING_RSSI_THRESHOLD) {
+        requestScan();
+      }
+      break;
+    case Roam_Scanning:
+      if (WiFi.scanComplete() == WIFI_SCAN_RUNNING) return;
+      evaluateScan();
+      break;
+    case Roam_Associating:
+      if (WiFi.status() == WL_CONNECTED) {
+        stats.lastAssociationMs = now - roamStart;
+        state = mqttIP.length() > 0 ? Roam_WaitingMqtt : Roam_Idle;
+        LOG_I("WIFI", "Roamed to %s, associated in %lu ms", WiFi.BSSIDstr().c_str(), (unsigned long) stats.lastAssociationMs);
+      } else if (now - roamStart > ROAMING_ASSOCIATION_TIMEOUT) {
+        // the reconnection of the WiFi manager takes over
+        state = Roam_Idle;
+      }
+      break;
+    case Roam_WaitingMqtt:
+      if (QueueManager::getMqttClient().connected()) {
+        stats.lastMqttOutageMs = now - roamStart;
+        if (stats.lastMqttOutageMs > stats.maxMqttOutageMs) stats.maxMqttOutageMs = stats.lastMqttOutageMs;
+        state = Roam_Idle;
+      } else if (WiFi.status() != WL_CONNECTED) {
+        state = Roam_Idle;
+      }
+      break;
+    default:
+      state = Roam_Idle;
+      break;
+  }
+}
+
+// pick the strongest known access point that beats the current one by ROAMING_RSSI_MARGIN
+void RoamingManager::evaluateScan() {
+  int16_t found = WiFi.scanComplete();
+  state = Roam_Idle;
+  if (found <= 0 || WiFi.status() != WL_CONNECTED) {
+    WiFi.scanDelete();
+    return;
+  }
+  int32_t currentRssi = WiFi.RSSI();
+  uint8_t currentBssid[6];
+  memcpy(currentBssid, WiFi.BSSID(), sizeof(currentBssid));
+  int16_t best = -1;
+  int8_t bestNetwork = -1;
+  int32_t bestRssi = currentRssi + ROAMING_RSSI_MARGIN - 1;
+  for (int16_t i = 0; i < found; i++) {
+    if (WiFi.RSSI(i) <= bestRssi || memcmp(WiFi.BSSID(i), currentBssid, sizeof(currentBssid)) == 0) continue;
+    int8_t network = findNetwork(WiFi.SSID(i));
+    if (network < 0) continue;
+    best = i;
+    bestNetwork = network;
+    bestRssi = WiFi.RSSI(i);
+  }
+  if (best < 0) {
+    WiFi.scanDelete();
+    return;
+  }
+  uint8_t bssid[6];
+  memcpy(bssid, WiFi.BSSID(best), sizeof(bssid));
+  int32_t channel = WiFi.channel(best);
+  WiFi.scanDelete();
+  LOG_W("WIFI", "Roaming from %ld dBm to %s, %ld dBm", (long) currentRssi, networks[bestNetwork].ssid.c_str(), (long) bestRssi);
+  stats.roams++;
+  lastRoam = millis();
+  roamStart = lastRoam;
+  state = Roam_Associating;
+  join(networks[bestNetwork].ssid.c_str(), networks[bestNetwork].pass.c_str(), channel, bssid);
+}
+
+void RoamingManager::beginNext() {
+  if (networkCount == 0) {
+    join(qsid.c_str(), qpass.c_str());
+    return;
+  }
+  const WifiCredentials &network = networks[nextNetwork];
+  nextNetwork = (nextNetwork + 1) % networkCount;
+  join(network.ssid.c_str(), network.pass.c_str());
+}
+
+// roams and reconnection cycles happen every few seconds, saving each join would wear the flash out
+void RoamingManager::join(const char *ssid, const char *pass, int32_t channel, const uint8_t *bssid) {
+  WiFi.persistent(false);
+  WiFi.begin(ssid, pass, channel, bssid);
+  WiFi.persistent(true);
+}
+
+const RoamingStats &RoamingManager::getStats() {
+  return stats;
+}
+
+void RoamingManager::addTo(JsonObject object) {
+  object["roams"] = stats.roams;
+  object["roamAssocMs"] = stats.lastAssociationMs;
+  object["roamMqttMs"] = stats.lastMqttOutageMs;
+}
@@ -0,0 +1,90 @@
+/*
+  RoamingManager.h - Multi network WiFi roaming by RSSI
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_ROAMING_MANAGER_H
+#define _DPSOFTWARE_ROAMING_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Configuration.h"
+#include "FixedString.h"
+
+struct WifiCredentials {
+    FixedString<33> ssid;
+    FixedString<65> pass;
+};
+
+struct RoamingStats {
+    uint32_t scans; // background scans started because the signal was weak
+    uint32_t roams; // moves to a stronger access point
+    uint32_t lastAssociationMs; // from the roaming decision to the association with the new access point
+    uint32_t lastMqttOutageMs; // from the roaming decision to the MQTT connection on the new access point
+    uint32_t maxMqttOutageMs;
+};
+
+/*
+  Keeps the WiFi networks of the setup file, qsid/qpass first and then the "networks" list:
+    "networks": [{"qsid": "warehouse", "qpass": "secret"}, {"qsid": "office", "qpass": "secret"}]
+  Every ROAMING_CHECK_INTERVAL milliseconds, when the RSSI is below ROAMING_RSSI_THRESHOLD, the access points are scanned
+  in background and the node moves to the strongest known BSSID that is at least ROAMING_RSSI_MARGIN dB better.
+  The channel and the BSSID of the scan are given to the association, so the move doesn't need another scan.
+  When the connection is lost the reconnection cycles through the configured networks.
+  These joins don't save the credentials to flash, the network of the setup file is saved only by the first connection.
+*/
+class RoamingManager {
+
+private:
+    static WifiCredentials networks[WIFI_MAX_NETWORKS];
+    static uint8_t networkCount;
+    static uint8_t nextNetwork;
+    static uint8_t state;
+    static unsigned long checkedAt;
+    static unsigned long roamStart;
+    static unsigned long lastRoam;
+    static RoamingStats stats;
+
+    static void poll(); // called by the scheduler
+
+    static void evaluateScan();
+
+    static int8_t findNetwork(const String &ssid);
+
+    static void join(const char *ssid, const char *pass, int32_t channel = 0, const uint8_t *bssid = nullptr);
+
+public:
+    static void begin();
+
+    static void clearNetworks();
+
+    static bool addNetwork(const char *ssid, const char *pass); // false when the list is full
+
+    static void addNetworks(JsonArrayConst list); // the "networks" list of the setup file
+
+    static uint8_t getNetworkCount();
+
+    static bool requestScan(); // scan now if roaming is possible, false otherwise
+
+    static void beginNext(); // connect to the next configured network, used while the connection is down
+
+    static const RoamingStats &getStats();
+
+    static void addTo(JsonObject object); // roaming fields for the state message
+};
+
+#endif
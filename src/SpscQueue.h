@@ -0,0 +1,95 @@
+/*
+  SpscQueue.h - Lock-free single-producer/single-consumer ring buffer
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_SPSC_QUEUE_H
+#define _DPSOFTWARE_SPSC_QUEUE_H
+
+#include <Arduino.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <atomic>
+#endif
+
+/*
+  Ring buffer of preallocated slots, one task can produce while another one consumes without locks.
+  Slots are filled and read in place to avoid copies:
+    producer: T *slot = queue.acquire(); if (slot) { fill slot; queue.commit(); }
+    consumer: T *slot = queue.peek(); if (slot) { read slot; queue.release(); }
+*/
+template<typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+private:
+    T slots[N];
+#if defined(ARDUINO_ARCH_ESP32)
+    // producer and consumer can run on different cores
+    std::atomic<uint32_t> head{0}; // next slot to read, written by the consumer only
+    std::atomic<uint32_t> tail{0}; // next slot to write, written by the producer only
+
+    static uint32_t load(const std::atomic<uint32_t> &index) { return index.load(std::memory_order_acquire); }
+
+    static void store(std::atomic<uint32_t> &index, uint32_t value) { index.store(value, std::memory_order_release); }
+#else
+    // single core, aligned 32 bit accesses are atomic, a compiler barrier is enough
+    volatile uint32_t head = 0;
+    volatile uint32_t tail = 0;
+
+    static uint32_t load(const volatile uint32_t &index) { return index; }
+
+    static void store(volatile uint32_t &index, uint32_t value) {
+      __asm__ __volatile__("" ::: "memory");
+      index = value;
+    }
+#endif
+
+public:
+    // producer side, returns the next free slot or nullptr if the queue is full
+    T *acquire() {
+      uint32_t t = load(tail);
+      if (t - load(head) >= N) return nullptr;
+      return &slots[t & (N - 1)];
+    }
+
+    // producer side, publish the slot returned by acquire()
+    void commit() {
+      store(tail, load(tail) + 1);
+    }
+
+    // consumer side, returns the oldest slot or nullptr if the queue is empty
+    T *peek() {
+      uint32_t h = load(head);
+      if (h == load(tail)) return nullptr;
+      return &slots[h & (N - 1)];
+    }
+
+    // consumer side, free the slot returned by peek()
+    void release() {
+      store(head, load(head) + 1);
+    }
+
+    size_t size() const {
+      return load(tail) - load(head);
+    }
+
+    static constexpr size_t capacity() {
+      return N;
+    }
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*
+  TaskScheduler.cpp - Cooperative scheduler for periodic and one-shot tasks
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include "TaskScheduler.h"
+
+TaskScheduler::Task TaskScheduler::tasks[MAX_SCHEDULED_TASKS];
+int8_t TaskScheduler::wheel[SCHEDULER_WHEEL_SLOTS];
+uint32_t TaskScheduler::currentTick = 0;
+unsigned long TaskScheduler::lastTickMillis = 0;
+bool TaskScheduler::initialized = false;
+
+void TaskScheduler::init() {
+  for (int8_t &slot : wheel) {
+    slot = -1;
+  }
+  for (Task &task : tasks) {
+    task.used = false;
+    task.generation = 0;
+  }
+  currentTick = 0;
+  lastTickMillis = millis();
+  initialized = true;
+}
+
+int16_t TaskScheduler::every(unsigned long intervalMs, void (*callback)(), unsigned long budgetMicros) {
+  return addTask(intervalMs, intervalMs, callback, budgetMicros);
+}
+
+int16_t TaskScheduler::once(unsigned long delayMs, void (*callback)()) {
+  return addTask(delayMs, 0, callback, 0);
+}
+
+int16_t TaskScheduler::addTask(unsigned long delayMs, unsigned long intervalMs, void (*callback)(), unsigned long budgetMicros) {
+  if (!initialized) init();
+  if (callback == nullptr) return -1;
+  for (int8_t i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    if (!tasks[i].used) {
+      Task &task = tasks[i];
+      task.callback = callback;
+      // tasks are run at the first tick after the delay has elapsed
+      task.dueTick = currentTick + (delayMs + SCHEDULER_TICK - 1) / SCHEDULER_TICK;
+      if (task.dueTick == currentTick) task.dueTick++;
+      task.intervalTicks = intervalMs == 0 ? 0 : max(1UL, intervalMs / SCHEDULER_TICK);
+      task.budgetMicros = budgetMicros;
+      task.used = true;
+      task.active = true;
+      memset(&task.stats, 0, sizeof(TaskStats));
+      insert(i);
+      return (int16_t) (task.generation << 8 | i);
+    }
+  }
+  Serial.println(F("No free slots in the task scheduler"));
+  return -1;
+}
+
+void TaskScheduler::insert(int8_t taskId) {
+  uint8_t slot = tasks[taskId].dueTick & (SCHEDULER_WHEEL_SLOTS - 1);
+  tasks[taskId].next = wheel[slot];
+  wheel[slot] = taskId;
+}
+
+int8_t TaskScheduler::slotOf(int16_t taskId) {
+  if (taskId < 0) return -1;
+  uint8_t slot = taskId & 0xFF;
+  if (slot >= MAX_SCHEDULED_TASKS || !tasks[slot].used || tasks[slot].generation != taskId >> 8) return -1;
+  return slot;
+}
+
+// cancelled tasks are released when their wheel slot is visited
+bool TaskScheduler::cancel(int16_t taskId) {
+  int8_t slot = slotOf(taskId);
+  if (slot < 0 || !tasks[slot].active) return false;
+  tasks[slot].active = false;
+  return true;
+}
+
+// a new generation invalidates the ids handed out for this slot
+void TaskScheduler::release(int8_t taskId) {
+  tasks[taskId].used = false;
+  tasks[taskId].generation = (tasks[taskId].generation + 1) & 0x7F;
+}
+
+void TaskScheduler::execute(int8_t taskId) {
+  Task &task = tasks[taskId];
+  unsigned long start = micros();
+  task.callback();
+  unsigned long elapsed = micros() - start;
+  task.stats.runs++;
+  task.stats.lastMicros = elapsed;
+  task.stats.totalMicros += elapsed;
+  if (elapsed > task.stats.maxMicros) task.stats.maxMicros = elapsed;
+  if (task.budgetMicros > 0 && elapsed > task.budgetMicros) task.stats.overruns++;
+}
+
+void TaskScheduler::run() {
+  if (!initialized) init();
+  unsigned long now = millis();
+  uint32_t elapsedTicks = (now - lastTickMillis) / SCHEDULER_TICK;
+  if (elapsedTicks == 0) return;
+  lastTickMillis += elapsedTicks * SCHEDULER_TICK;
+  uint32_t firstTick = currentTick + 1;
+  currentTick += elapsedTicks;
+  // when more than a full revolution has elapsed every slot is visited once
+  uint32_t slotsToVisit = elapsedTicks < SCHEDULER_WHEEL_SLOTS ? elapsedTicks : SCHEDULER_WHEEL_SLOTS;
+  for (uint32_t tick = firstTick; tick < firstTick + slotsToVisit; tick++) {
+    uint8_t slot = tick & (SCHEDULER_WHEEL_SLOTS - 1);
+    // detach the slot, tasks that are not due or are periodic are inserted again
+    int8_t taskId = wheel[slot];
+    wheel[slot] = -1;
+    while (taskId >= 0) {
+      Task &task = tasks[taskId];
+      int8_t next = task.next;
+      if (task.active && (int32_t) (task.dueTick - currentTick) <= 0) {
+        execute(taskId);
+        if (task.active && task.intervalTicks > 0) {
+          task.dueTick += task.intervalTicks;
+          if ((int32_t) (task.dueTick - currentTick) <= 0) {
+            // the next period is already due, skip the missed runs instead of bursting
+            task.stats.lateRuns++;
+            task.dueTick = currentTick + task.intervalTicks;
+          }
+          insert(taskId);
+        } else {
+          release(taskId);
+        }
+      } else if (task.active) {
+        insert(taskId);
+      } else {
+        release(taskId);
+      }
+      taskId = next;
+    }
+  }
+}
+
+const TaskStats *TaskScheduler::getStats(int16_t taskId) {
+  int8_t slot = slotOf(taskId);
+  return slot < 0 ? nullptr : &tasks[slot].stats;
+}
+
+void TaskScheduler::printStats(Print &out) {
+  for (int8_t i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    if (!tasks[i].used) continue;
+    const TaskStats &stats = tasks[i].stats;
+    out.printf("Task %d: runs=%lu avg=%luus max=%luus overruns=%lu late=%lu\n", i, (unsigned long) stats.runs,
+               stats.runs > 0 ? (unsigned long) (stats.totalMicros / stats.runs) : 0UL, stats.maxMicros,
+               (unsigned long) stats.overruns, (unsigned long) stats.lateRuns);
+  }
+}
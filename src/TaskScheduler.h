@@ -0,0 +1,90 @@
+/*
+  TaskScheduler.h - Cooperative scheduler for periodic and one-shot tasks
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_TASK_SCHEDULER_H
+#define _DPSOFTWARE_TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+// Number of slots in the timer wheel, must be a power of two
+#define SCHEDULER_WHEEL_SLOTS 32
+
+struct TaskStats {
+    uint32_t runs; // number of executions
+    uint32_t overruns; // executions that took longer than the task budget
+    uint32_t lateRuns; // executions started after the next period was already due
+    unsigned long lastMicros; // duration of the last execution
+    unsigned long maxMicros; // worst execution time
+    uint64_t totalMicros; // total execution time
+};
+
+/*
+  Tasks are stored in a hashed timer wheel with SCHEDULER_WHEEL_SLOTS slots of SCHEDULER_TICK milliseconds,
+  every loop only the slots elapsed since the previous loop are visited, tasks are never run concurrently.
+  A task id carries the generation of its slot, the id of a finished or cancelled task is not reused for 128 tasks
+  in the same slot, so a stale id is rejected by cancel() and getStats() instead of matching an unrelated task.
+  Usage:
+    int16_t id = TaskScheduler::every(1000, myTask); // run myTask every second
+    TaskScheduler::once(5000, myOtherTask); // run myOtherTask once in 5 seconds
+    TaskScheduler::cancel(id);
+*/
+class TaskScheduler {
+
+private:
+    struct Task {
+        void (*callback)();
+        uint32_t dueTick;
+        uint32_t intervalTicks; // 0 for one-shot tasks
+        unsigned long budgetMicros; // 0 means no budget
+        int8_t next; // next task in the same wheel slot
+        uint8_t generation; // incremented when the slot is released, 7 bits so that ids are positive
+        bool used;
+        bool active;
+        TaskStats stats;
+    };
+
+    static Task tasks[MAX_SCHEDULED_TASKS];
+    static int8_t wheel[SCHEDULER_WHEEL_SLOTS];
+    static uint32_t currentTick;
+    static unsigned long lastTickMillis;
+    static bool initialized;
+
+    static void init();
+
+    static int8_t slotOf(int16_t taskId); // slot of a live task, -1 for invalid or stale ids
+
+    static int16_t addTask(unsigned long delayMs, unsigned long intervalMs, void (*callback)(), unsigned long budgetMicros);
+
+    static void insert(int8_t taskId);
+
+    static void execute(int8_t taskId);
+
+    static void release(int8_t taskId);
+
+public:
+    static int16_t every(unsigned long intervalMs, void (*callback)(), unsigned long budgetMicros = 0); // run a task periodically, returns the task id or -1
+    static int16_t once(unsigned long delayMs, void (*callback)()); // run a task once after delayMs, returns the task id or -1
+    static bool cancel(int16_t taskId); // cancel a task
+    static void run(); // dispatch the tasks that are due, called by bootstrapLoop()
+    static const TaskStats *getStats(int16_t taskId); // run time accounting for a task
+    [[maybe_unused]] static void printStats(Print &out); // print run time accounting for all the tasks
+};
+
+#endif
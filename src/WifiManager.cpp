@@ -18,6 +18,10 @@
 */
 
 #include "WifiManager.h"
+#include "JsonArena.h"
+#include "RoamingManager.h"
+#include "OtaManager.h"
+#include "QueueManager.h"
 
 //Establishing Local server at port 80 whenever required
 #if defined(ESP8266)
@@ -40,7 +44,13 @@ char cmDNS[33] = "x";
 char clientSSID[33];
 char clientPass[65];
 unsigned long previousMillisEsp32Reconnect = 0;
+// set by the GOT_IP event that follows the join requested by Improv
+static volatile bool improvJoinGotIp = false;
+#if defined(ESP8266)
+static WiFiEventHandler improvGotIpHandler;
+#endif
 unsigned long intervalEsp32Reconnect = 15000;
+int WifiManager::shownAttempt = 0;
 
 /********************************** SETUP WIFI *****************************************/
 void WifiManager::setupWiFi(void (*manageDisconnections)(), void (*manageHardwareButton)()) {
@@ -73,23 +83,11 @@ void WifiManager::setupWiFi(void (*manageDisconnections)(), void (*manageHardwar
 //  WiFi.setAutoConnect(true); // TODO
   WiFi.setAutoReconnect(true);
   Serial.println(microcontrollerIP);
-  if (!microcontrollerIP.equals("DHCP")) {
-    WiFi.config(IPAddress(Helpers::getValue(microcontrollerIP, '.', 0).toInt(),
-                          Helpers::getValue(microcontrollerIP, '.', 1).toInt(),
-                          Helpers::getValue(microcontrollerIP, '.', 2).toInt(),
-                          Helpers::getValue(microcontrollerIP, '.', 3).toInt()),
-                IPAddress(Helpers::getValue(IP_GATEWAY, '.', 0).toInt(),
-                          Helpers::getValue(IP_GATEWAY, '.', 1).toInt(),
-                          Helpers::getValue(IP_GATEWAY, '.', 2).toInt(),
-                          Helpers::getValue(IP_GATEWAY, '.', 3).toInt()),
-                IPAddress(Helpers::getValue(IP_SUBNET, '.', 0).toInt(),
-                          Helpers::getValue(IP_SUBNET, '.', 1).toInt(),
-                          Helpers::getValue(IP_SUBNET, '.', 2).toInt(),
-                          Helpers::getValue(IP_SUBNET, '.', 3).toInt()),
-                IPAddress(Helpers::getValue(IP_DNS, '.', 0).toInt(),
-                          Helpers::getValue(IP_DNS, '.', 1).toInt(),
-                          Helpers::getValue(IP_DNS, '.', 2).toInt(),
-                          Helpers::getValue(IP_DNS, '.', 3).toInt()));
+  if (!bootstrapConfig.isDhcp()) {
+    WiFi.config(bootstrapConfig.getMicrocontrollerIp(),
+                BootstrapConfig::toIp(IP_GATEWAY),
+                BootstrapConfig::toIp(IP_SUBNET),
+                BootstrapConfig::toIp(IP_DNS));
     Serial.println(F("Using static IP address"));
     dhcpInUse = false;
   } else {
@@ -97,10 +95,10 @@ void WifiManager::setupWiFi(void (*manageDisconnections)(), void (*manageHardwar
     dhcpInUse = true;
   }
 #if defined(ESP8266)
-  WiFi.hostname(Helpers::string2char(deviceName));
+  WiFi.hostname(deviceName.c_str());
   // Set wifi power in dbm range 0/0.25, set to 0 to reduce PIR false positive due to wifi power, 0 low, 20.5 max.
   WiFi.setOutputPower(WIFI_POWER);
-  if (microcontrollerIP.equals("DHCP")) {
+  if (bootstrapConfig.isDhcp()) {
     WiFi.config(0U, 0U, 0U);
   }
   WiFi.onStationModeDisconnected([](const WiFiEventStationModeDisconnected &event) {
@@ -108,7 +106,7 @@ void WifiManager::setupWiFi(void (*manageDisconnections)(), void (*manageHardwar
       WiFi.reconnect();
   });
 #elif defined(ARDUINO_ARCH_ESP32)
-  WiFi.setHostname(helper.string2char(deviceName));
+  WiFi.setHostname(deviceName.c_str());
 #if !CONFIG_IDF_TARGET_ESP32S2
   btStop();
 #endif
@@ -174,34 +172,33 @@ void WifiManager::reconnectToWiFi(void (*manageDisconnections)(), void (*manageH
       if (fastDisconnectionManagement) {
         manageDisconnections();
       }
-#if (DISPLAY_ENABLED)
-      display.setCursor(0,0);
-      display.clearDisplay();
-      display.setTextSize(1);
-#endif
 #if defined(ESP8266)
       ESP.wdtFeed();
 #else
       esp_task_wdt_reset();
 #endif
-      Helpers::smartPrint(F("Wifi attemps= "));
-      Helpers::smartPrintln(wifiReconnectAttemp);
+      shownAttempt = wifiReconnectAttemp;
+      QueueManager::runOnApplicationTask(showAttempt);
+#if defined(ESP8266)
+      // try the other configured networks every 15 seconds
+      if (RoamingManager::getNetworkCount() > 1 && wifiReconnectAttemp % 30 == 0) {
+        RoamingManager::beginNext();
+      }
+#endif
 #if defined(ARDUINO_ARCH_ESP32)
       // Arduino 2.x for ESP32 seems to not support callback, polling to reconnect.
       unsigned long currentMillisEsp32Reconnect = millis();
       if (currentMillisEsp32Reconnect - previousMillisEsp32Reconnect >= intervalEsp32Reconnect) {
         WiFi.disconnect();
-        WiFi.begin(qsid.c_str(), qpass.c_str());
+        RoamingManager::beginNext();
         setTxPower();
         WiFi.setSleep(false);
         previousMillisEsp32Reconnect = currentMillisEsp32Reconnect;
       }
 #endif
       if (wifiReconnectAttemp >= MAX_RECONNECT) {
-        Helpers::smartPrintln(F("Max retry reached, powering off peripherals."));
         manageDisconnections();
       }
-      helper.smartDisplay();
     } else if (wifiReconnectAttemp > 10000) {
       wifiReconnectAttemp = 0;
     }
@@ -210,39 +207,58 @@ void WifiManager::reconnectToWiFi(void (*manageDisconnections)(), void (*manageH
     }
   }
   if (currentWiFiIp != WiFi.localIP()) {
-    Helpers::smartPrint(F("\nWIFI CONNECTED\nIP Address: "));
     if (!ethConnected) {
       microcontrollerIP = WiFi.localIP().toString();
     }
     currentWiFiIp = WiFi.localIP();
-    Helpers::smartPrintln(WiFi.localIP().toString());
-    Helpers::smartPrint(F("nb of attempts: "));
-    Helpers::smartPrintln(wifiReconnectAttemp);
+    shownAttempt = wifiReconnectAttemp;
+    QueueManager::runOnApplicationTask(showConnected);
   }
   if (WiFi.status() == WL_CONNECTED || ethConnected) {
     wifiReconnectAttemp = 0;
   }
 }
 
+// the display is drawn by the loop task only, reconnectToWiFi() can run in the network task
+void WifiManager::showAttempt() {
+#if (DISPLAY_ENABLED)
+  display.setCursor(0,0);
+  display.clearDisplay();
+  display.setTextSize(1);
+#endif
+  Helpers::smartPrint(F("Wifi attemps= "));
+  Helpers::smartPrintln(shownAttempt);
+  if (shownAttempt >= MAX_RECONNECT) {
+    Helpers::smartPrintln(F("Max retry reached, powering off peripherals."));
+  }
+  Helpers helper;
+  helper.smartDisplay();
+}
+
+void WifiManager::showConnected() {
+  Helpers::smartPrint(F("\nWIFI CONNECTED\nIP Address: "));
+  Helpers::smartPrintln(currentWiFiIp);
+  Helpers::smartPrint(F("nb of attempts: "));
+  Helpers::smartPrintln(shownAttempt);
+}
+
 /********************************** SETUP OTA *****************************************/
 void WifiManager::setupOTAUpload() {
   //OTA SETUP
   ArduinoOTA.setPort(OTA_PORT);
   // Hostname defaults to esp8266-[ChipID]
-  ArduinoOTA.setHostname(Helpers::string2char(deviceName));
+  ArduinoOTA.setHostname(deviceName.c_str());
   // No authentication by default
-  ArduinoOTA.setPassword((const char *) Helpers::string2char(OTApass));
+  ArduinoOTA.setPassword(OTApass.c_str());
   ArduinoOTA.onStart([]() {
+      OtaManager::resetProgress();
       Serial.println(F("Starting"));
   });
   ArduinoOTA.onEnd([]() {
       Serial.println(F("End"));
   });
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-#if defined(ARDUINO_ARCH_ESP32)
-    esp_task_wdt_reset();
-# endif
-      Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
+      OtaManager::progress(progress, total);
   });
   ArduinoOTA.onError([](ota_error_t error) {
       Serial.printf("Error[%u]: ", error);
@@ -312,6 +328,7 @@ void WifiManager::launchWebServerCustom(void (*listener)()) {
 // Manage improv wifi
 void WifiManager::manageImprovWifi() {
   handleImprovPacket();
+  delay(1);
 }
 
 void WifiManager::launchWeb() {
@@ -518,7 +535,7 @@ void WifiManager::createWebServer() {
         String mqttuser = server.arg("mqttuser");
         String mqttpass = server.arg("mqttpass");
         String additionalParam = server.arg("additionalParam");
-        JsonDocument doc;
+        JsonDocument doc(&scratchArena);
 
         if (deviceName.length() > 0 && qsid.length() > 0 && qpass.length() > 0 && OTApass.length() > 0
             && ((mqttCheckbox.length() == 0) || (mqttIP.length() > 0 && mqttPort.length() > 0))) {
@@ -707,187 +724,248 @@ void WifiManager::parseWiFiCommand(char *rpcData) {
   memset(clientPass, 0, 64);
   if (len > ssidLen + 1) {
     uint8_t passLen = rpcData[2 + ssidLen];
+    if (passLen > len - ssidLen - 2 || passLen > 64) return;
     memset(clientPass, 0, 64);
     memcpy(clientPass, rpcData + 3 + ssidLen, passLen);
   }
+  if (improvError == 0x03) sendImprovStateResponse(0x00, true); //clear the previous connection error
   sendImprovStateResponse(0x03, false); //provisioning
   improvActive = 2;
-  JsonDocument doc;
-  bool connected = isConnected();
-  String devName = String(random(0, 90000));
-  doc["deviceName"] = String(DEVICE_NAME) + "_" + devName;
-  doc["microcontrollerIP"] = "DHCP";
-  doc["qsid"] = clientSSID;
-  doc["qpass"] = clientPass;
-  doc["OTApass"] = "";
-  doc["mqttIP"] = "";
-  doc["mqttPort"] = "";
-  doc["mqttuser"] = "";
-  doc["mqttpass"] = "";
-  additionalParam = "2";
-  File jsonFile = LittleFS.open("/setup.json", FILE_WRITE);
-  if (!jsonFile) {
-    Serial.println("Failed to open [setup.json] file for writing");
-  } else {
+  // join the network without waiting for it, checkImprovWifiJoin() reports the result from the loop
+  WiFi.disconnect();
+  improvJoinGotIp = false;
+#if defined(ESP8266)
+  if (!improvGotIpHandler) {
+    improvGotIpHandler = WiFi.onStationModeGotIP([](const WiFiEventStationModeGotIP &event) {
+        improvJoinGotIp = true;
+    });
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  static bool improvEventRegistered = false;
+  if (!improvEventRegistered) {
+    improvEventRegistered = true;
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        improvJoinGotIp = true;
+    }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  }
+#endif
+  WiFi.begin(clientSSID, clientPass);
+  improvJoinStartMillis = millis();
+  improvJoinPending = true;
+}
+
+// check the WiFi join requested by Improv, the config is persisted only once the connection has been verified
+void WifiManager::checkImprovWifiJoin() {
+  if (!improvJoinPending) return;
+  // the previous association can still report connected, especially on ESP32 where disconnect() is async
+  if (improvJoinGotIp && isConnected() && WiFi.SSID().equals(clientSSID)) {
+    improvJoinPending = false;
+    JsonDocument doc(&scratchArena);
+    String devName = String(random(0, 90000));
+    doc["deviceName"] = String(DEVICE_NAME) + "_" + devName;
+    doc["microcontrollerIP"] = "DHCP";
+    doc["qsid"] = clientSSID;
+    doc["qpass"] = clientPass;
+    doc["OTApass"] = "";
+    doc["mqttIP"] = "";
+    doc["mqttPort"] = "";
+    doc["mqttuser"] = "";
+    doc["mqttpass"] = "";
+    additionalParam = "2";
+    File jsonFile = LittleFS.open("/setup.json", FILE_WRITE);
+    if (!jsonFile) {
+      Serial.println("Failed to open [setup.json] file for writing");
+      sendImprovStateResponse(0xFF, true); //unknown error
+      improvActive = 1;
+      return;
+    }
     serializeJsonPretty(doc, Serial);
     serializeJson(doc, jsonFile);
     jsonFile.close();
-    if (connected) {
-      IPAddress localIP = WiFi.localIP();
-      Serial.printf("IMPROV http://%d.%d.%d.%d\n", localIP[0], localIP[1], localIP[2], localIP[3]);
-    }
-  }
-#if defined(ARDUINO_ARCH_ESP32)
-  WiFi.disconnect();
-  WiFi.begin(clientSSID, clientPass);
-  while (!isConnected()) {}
-#endif
-  sendImprovRPCResponse(ImprovRPCType::Request_State);
-  sendImprovStateResponse(0x04, false);
+    IPAddress localIP = WiFi.localIP();
+    Serial.printf("IMPROV http://%d.%d.%d.%d\n", localIP[0], localIP[1], localIP[2], localIP[3]);
+    sendImprovRPCResponse(ImprovRPCType::Request_State);
+    sendImprovStateResponse(0x04, false);
 #if CONFIG_IDF_TARGET_ESP32 || defined(ESP8266)
-  Serial.flush();
+    Serial.flush();
 #endif
-  delay(200);
+    delay(200);
 #if defined(ARDUINO_ARCH_ESP32)
-  ESP.restart();
+    ESP.restart();
 #elif defined(ESP8266)
-  EspClass::restart();
+    EspClass::restart();
 #endif
+  } else if (millis() - improvJoinStartMillis > IMPROV_WIFI_TIMEOUT) {
+    improvJoinPending = false;
+    Serial.println(F("IMPROV unable to connect"));
+    sendImprovStateResponse(0x03, true); //unable to connect
+    sendImprovStateResponse(0x02, false); //back to authorized, ready for new credentials
+    improvActive = 1;
+    WiFi.disconnect();
+    // go back to the previous network if there was one
+    if (isConfigFileOk) {
+      WiFi.begin(qsid.c_str(), qpass.c_str());
+    }
   }
+}
 
-//blocking function to parse an Improv Serial packet
+// non-blocking Improv Serial parser, consumes the bytes already received and keeps its state between loops
 void WifiManager::handleImprovPacket() {
-  uint8_t header[6] = {'I', 'M', 'P', 'R', 'O', 'V'};
-  uint8_t headerEth[6] = {'D', 'P', 'S', 'E', 'T', 'H'};
-
-  bool timeout = false;
-  uint16_t packetByte = 0;
-  uint8_t packetLen = 9;
-  uint8_t checksum = 0;
-  uint8_t waitTime = 255;
-  uint8_t rpcCommandType = 0;
-  char rpcData[128];
-  rpcData[0] = 0;
-  while (!timeout) {
-    if (Serial.available() < 1) {
-      delay(1);
-      waitTime--;
-      if (!waitTime) timeout = true;
-      continue;
+  checkImprovWifiJoin();
+  if (dpseth.isActive() && millis() - improvLastByteMillis > DPSETH_BYTE_TIMEOUT) {
+    DIMPROV_PRINTLN(F("DPSETH packet timeout"));
+    dpseth.reset();
+  }
+  if (improv.isReceiving() && millis() - improvLastByteMillis > IMPROV_BYTE_TIMEOUT) {
+    DIMPROV_PRINTLN(F("Improv packet timeout"));
+    improv.reset();
+  }
+  while (Serial.available() > 0) {
+    improvLastByteMillis = millis();
+    uint8_t next = Serial.read();
+    if (dpseth.isActive()) {
+      processDpsethByte(next);
+    } else {
+      processImprovByte(next);
     }
-    byte next = Serial.read();
-    DIMPROV_PRINT("Received improv byte: "); DIMPROV_PRINTF("%x\r\n", next);
-    switch (packetByte) {
-      case ImprovPacketByte::Version: {
-        if (next != IMPROV_VERSION) {
-          DIMPROV_PRINTLN(F("Invalid version"));
-          return;
-        }
-        break;
+  }
+}
+
+// feed a single byte to the Improv parser and act on complete packets
+void WifiManager::processImprovByte(uint8_t next) {
+  DIMPROV_PRINT("Received improv byte: "); DIMPROV_PRINTF("%x\r\n", next);
+  switch (improv.feed(next)) {
+    case Improv_Invalid:
+      DIMPROV_PRINTLN(F("Invalid improv packet"));
+      break;
+    case Improv_Rpc_Started:
+      if (!improvActive) {
+        improvActive = 1;
+        improvePacketReceived = true;
       }
-      case ImprovPacketByte::PacketType: {
-        if (next != ImprovPacketType::RPC_Command) {
-          DIMPROV_PRINTF("Non RPC-command improv packet type %i\n", next);
-          return;
+      break;
+    case Improv_Bad_Checksum:
+      DIMPROV_PRINTLN(F("Wrong RPC checksum"));
+      sendImprovStateResponse(0x01, true);
+      break;
+    case Improv_Dpseth_Header:
+      // This is a custom dpsoftware improv protocol
+      dpseth.start();
+      break;
+    case Improv_Rpc_Command:
+      switch (improv.getRpcCommandType()) {
+        case ImprovRPCType::Command_Wifi:
+          parseWiFiCommand(improv.getRpcData());
+          break;
+        case ImprovRPCType::Request_State: {
+          uint8_t improvState = 0x02; //authorized
+          if (isWifiConfigured()) improvState = 0x03; //provisioning
+          if (WiFi.localIP()[0] != 0 && WiFi.status() == WL_CONNECTED) improvState = 0x04; //provisioned
+          sendImprovStateResponse(improvState, false);
+          if (improvState == 0x04) sendImprovRPCResponse(ImprovRPCType::Request_State);
+          break;
         }
-        if (!improvActive) {
-          improvActive = 1;
-          improvePacketReceived = true;
+        case ImprovRPCType::Request_Info:
+          sendImprovInfoResponse();
+          break;
+        default: {
+          DIMPROV_PRINTF("Unknown RPC command %i\n", improv.getRpcCommandType());
+          sendImprovStateResponse(0x02, true);
         }
-        break;
       }
-      case ImprovPacketByte::Length:
-        packetLen = 9 + next;
-        break;
-      case ImprovPacketByte::RPC_CommandType:
-        rpcCommandType = next;
-        break;
-      default: {
-        if (packetByte >= packetLen) { //end of packet, check checksum match
-          if (checksum != next) {
-            DIMPROV_PRINTF("Got RPC checksum %i, expected %i", next, checksum);
-            sendImprovStateResponse(0x01, true);
-            return;
-          }
-          switch (rpcCommandType) {
-            case ImprovRPCType::Command_Wifi:
-              parseWiFiCommand(rpcData);
-              break;
-            case ImprovRPCType::Request_State: {
-              uint8_t improvState = 0x02; //authorized
-              if (isWifiConfigured()) improvState = 0x03; //provisioning
-              if (WiFi.localIP()[0] != 0 && WiFi.status() == WL_CONNECTED) improvState = 0x04; //provisioned
-              sendImprovStateResponse(improvState, false);
-              if (improvState == 0x04) sendImprovRPCResponse(ImprovRPCType::Request_State);
-              break;
-            }
-            case ImprovRPCType::Request_Info:
-              sendImprovInfoResponse();
-              break;
-            default: {
-              DIMPROV_PRINTF("Unknown RPC command %i\n", next);
-              sendImprovStateResponse(0x02, true);
-            }
-          }
-          return;
-        }
-        if (packetByte < 6) { //check header
-          if (next != header[packetByte] && next != headerEth[packetByte]) {
-            DIMPROV_PRINTLN(F("Invalid improv header"));
-            return;
-          }
-          // This is a custom dpsoftware improv protocol
-          if (next == headerEth[5]) {
-            char buffer[65];
-            JsonDocument doc;
-            for (int i = 0; i < 15; i++) {
-              size_t len = Serial.readBytesUntil('\n', buffer, 64);
-              buffer[len] = '\0';
-              switch (i) {
-                case 1: doc["deviceName"] = buffer; break;
-                case 2: doc["microcontrollerIP"] = buffer; break;
-                case 3: doc["qsid"] = buffer; break;
-                case 4: doc["qpass"] = buffer; break;
-                case 5: doc["OTApass"] = buffer; break;
-                case 6: doc["mqttIP"] = buffer; break;
-                case 7: doc["mqttPort"] = buffer; break;
-                case 8: doc["mqttuser"] = buffer; break;
-                case 9: doc["mqttpass"] = buffer; break;
-                case 10: doc["ethd"] = buffer; break;
-                case 11: doc["miso"] = buffer; break;
-                case 12: doc["mosi"] = buffer; break;
-                case 13: doc["sclk"] = buffer; break;
-                case 14: doc["cs"] = buffer; break;
-                default: break;
-              }
-            }
-            File jsonFile = LittleFS.open("/setup.json", FILE_WRITE);
-            if (!jsonFile) {
-              Serial.println("Failed to open [setup.json] file for writing");
-            } else {
-              serializeJsonPretty(doc, Serial);
-              serializeJson(doc, jsonFile);
-              jsonFile.close();
+      break;
+    default:
+      break;
+  }
+}
+
+// feed a single byte to the DPSETH parser and store complete packets
+void WifiManager::processDpsethByte(uint8_t next) {
+  switch (dpseth.feed(next)) {
+    case Dpseth_Too_Big:
+      DIMPROV_PRINTLN(F("DPSETH packet too big"));
+      sendImprovStateResponse(0x01, true);
+      break;
+    case Dpseth_Bad_Crc:
+      DIMPROV_PRINTLN(F("Wrong DPSETH CRC"));
+      sendImprovStateResponse(0x01, true);
+      break;
+    case Dpseth_Received:
+      parseDpsethFields();
+      break;
+    case Dpseth_Legacy_Received:
+      parseDpsethLegacyFields();
+      break;
+    default:
+      break;
+  }
+}
+
+// walk the TLV fields of a validated DPSETH packet
+void WifiManager::parseDpsethFields() {
+  JsonDocument doc(&scratchArena);
+  uint16_t pos = 0;
+  DpsethRecord field;
+  uint8_t result;
+  while ((result = dpseth.nextField(pos, field)) == Field_Read) {
+    const char *key = DpsethParser::fieldName(field.type);
+    JsonString value(field.value, field.length);
+    if (key == nullptr) {
+      DIMPROV_PRINTF("Skipping unknown DPSETH field %i\n", field.type);
+    } else if (field.type == Field_Mqtt_Broker) {
+      // "host:port" is stored like the brokers of BrokerManager, port 1883 when missing
+      int16_t separator = DpsethParser::brokerPortSeparator(field.value, field.length);
+      JsonObject broker = doc[key].add<JsonObject>();
+      if (separator < 0) {
+        broker[F("mqttIP")] = value;
+        broker[F("mqttPort")] = "1883";
+      } else {
+        broker[F("mqttIP")] = JsonString(field.value, separator);
+        broker[F("mqttPort")] = JsonString(field.value + separator + 1, field.length - separator - 1);
+      }
+    } else {
+      doc[key] = value;
+    }
+  }
+  if (result == Field_Truncated) {
+    DIMPROV_PRINTLN(F("Truncated DPSETH field"));
+    sendImprovStateResponse(0x01, true);
+    return;
+  }
+  storeProvisioningConfig(doc);
+}
+
+void WifiManager::parseDpsethLegacyFields() {
+  JsonDocument doc(&scratchArena);
+  uint16_t pos = 0;
+  uint8_t line = 0;
+  DpsethRecord field;
+  while (dpseth.nextLegacyField(pos, line, field)) {
+    const char *key = DpsethParser::fieldName(field.type);
+    if (key != nullptr) {
+      doc[key] = JsonString(field.value, field.length);
+    }
+  }
+  storeProvisioningConfig(doc);
+}
+
+// save the provisioned config and restart the microcontroller to use it
+void WifiManager::storeProvisioningConfig(const JsonDocument &doc) {
+  File jsonFile = LittleFS.open("/setup.json", FILE_WRITE);
+  if (!jsonFile) {
+    Serial.println("Failed to open [setup.json] file for writing");
+  } else {
+    serializeJsonPretty(doc, Serial);
+    serializeJson(doc, jsonFile);
+    jsonFile.close();
 #if CONFIG_IDF_TARGET_ESP32 || defined(ESP8266)
-              Serial.flush();
+    Serial.flush();
 #endif
-              delay(200);
+    delay(200);
 #if defined(ARDUINO_ARCH_ESP32)
-              ESP.restart();
+    ESP.restart();
 #elif defined(ESP8266)
-              EspClass::restart();
+    EspClass::restart();
 #endif
-            }
-          }
-        } else if (packetByte > 9) { //RPC data
-          rpcData[packetByte - 10] = next;
-          if (packetByte > 137) return; //prevent buffer overflow
-        }
-      }
-    }
-    checksum += next;
-    packetByte++;
   }
 }
-
-
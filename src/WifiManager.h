@@ -43,6 +43,7 @@
 #include "Helpers.h"
 #include "Secrets.h"
 #include "Configuration.h"
+#include "ImprovParser.h"
 
 //Establishing Local server at port 80 whenever required
 #if defined(ESP8266)
@@ -68,29 +69,14 @@ extern String htmlString;
 #define DIMPROV_PRINTLN(x)
 #define DIMPROV_PRINTF(x...)
 #endif
-#define IMPROV_VERSION 1
+#define IMPROV_BYTE_TIMEOUT 255 // max milliseconds between two bytes of the same packet
+#ifndef IMPROV_WIFI_TIMEOUT
+#define IMPROV_WIFI_TIMEOUT 15000 // max milliseconds to wait for the WiFi received via Improv
+#endif
 
-[[maybe_unused]] void parseWiFiCommand(char *rpcData);
+#define DPSETH_BYTE_TIMEOUT 1000 // max milliseconds between two bytes of the same packet
 
-enum ImprovPacketType {
-    Current_State = 0x01,
-    Error_State = 0x02,
-    RPC_Command = 0x03,
-    RPC_Response = 0x04
-};
-
-enum ImprovPacketByte {
-    Version = 6,
-    PacketType = 7,
-    Length = 8,
-    RPC_CommandType = 9
-};
-
-enum ImprovRPCType {
-    Command_Wifi = 0x01,
-    Request_State = 0x02,
-    Request_Info = 0x03
-};
+[[maybe_unused]] void parseWiFiCommand(char *rpcData);
 
 extern byte improvActive; //0: no improv packet received, 1: improv active, 2: provisioning
 extern byte improvError;
@@ -110,6 +96,29 @@ private:
 
     static void launchWeb();
 
+    // parsers state, kept between loops so that the parser never waits for bytes not yet received
+    ImprovParser improv;
+    DpsethParser dpseth;
+    unsigned long improvLastByteMillis = 0;
+    unsigned long improvJoinStartMillis = 0;
+    bool improvJoinPending = false;
+
+    void processImprovByte(uint8_t next);
+
+    void processDpsethByte(uint8_t next);
+
+    void parseDpsethFields();
+
+    void parseDpsethLegacyFields();
+
+    static void storeProvisioningConfig(const JsonDocument &doc);
+
+    static int shownAttempt; // attempt drawn by the loop task, the network task keeps counting meanwhile
+
+    static void showAttempt(); // reconnection messages, drawn by the loop task
+
+    static void showConnected();
+
 public:
     void setupWiFi(void (*manageDisconnections)(), void (*manageHardwareButton)());
 
@@ -129,6 +138,8 @@ public:
 
     void parseWiFiCommand(char *rpcData);
 
+    void checkImprovWifiJoin();
+
     void sendImprovRPCResponse(byte commandId);
 
     void sendImprovRPCResponse(byte commandId, bool forceConnection);
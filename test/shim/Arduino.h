@@ -0,0 +1,240 @@
+/*
+  Arduino.h - Minimal Arduino API for the native unit tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_TEST_ARDUINO_H
+#define _DPSOFTWARE_TEST_ARDUINO_H
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+/*
+  Only what the platform independent classes use: the clock, Serial, Print, Printable, IPAddress and String.
+  The clock is moved by the tests, nothing runs in real time.
+  Print and Serial never touch the heap, so that the tests can count the allocations of the code under test.
+*/
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+inline unsigned long fakeMillis = 0;
+inline unsigned long fakeMicros = 0;
+
+inline unsigned long millis() { return fakeMillis; }
+
+inline unsigned long micros() { return fakeMicros; }
+
+inline void delay(unsigned long ms) {
+  fakeMillis += ms;
+  fakeMicros += ms * 1000;
+}
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+#define PSTR(text) (text)
+#define PROGMEM
+#define PGM_P const char *
+#define strncpy_P strncpy
+#define vsnprintf_P vsnprintf
+
+class Print;
+
+class String;
+
+class Printable {
+public:
+    virtual ~Printable() = default;
+
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print {
+
+private:
+    template<typename T>
+    size_t printFormatted(const char *format, T value) {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), format, value);
+      return print(buffer);
+    }
+
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      size_t written = 0;
+      while (size-- > 0) written += write(*buffer++);
+      return written;
+    }
+
+    size_t write(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+
+    size_t print(const char *text) { return write(text); }
+
+    size_t print(const __FlashStringHelper *text) { return print(reinterpret_cast<const char *>(text)); }
+
+    size_t print(const String &text);
+
+    size_t print(char value) { return write((uint8_t) value); }
+
+    size_t print(unsigned char value) { return printFormatted("%u", (unsigned) value); }
+
+    size_t print(int value) { return printFormatted("%d", value); }
+
+    size_t print(unsigned int value) { return printFormatted("%u", value); }
+
+    size_t print(long value) { return printFormatted("%ld", value); }
+
+    size_t print(unsigned long value) { return printFormatted("%lu", value); }
+
+    size_t print(double value) { return printFormatted("%.2f", value); }
+
+    size_t print(const Printable &value) { return value.printTo(*this); }
+
+    size_t println() { return print("\r\n"); }
+
+    template<typename T>
+    size_t println(const T &value) { return print(value) + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+      char buffer[256];
+      va_list args;
+      va_start(args, format);
+      vsnprintf(buffer, sizeof(buffer), format, args);
+      va_end(args);
+      return print(buffer);
+    }
+};
+
+// Serial keeps what is written in a fixed buffer, the tests read it back with output() and reset it with clear()
+class HardwareSerial : public Print {
+
+private:
+    char buffer[1024] = {};
+    size_t length = 0;
+
+public:
+    size_t write(uint8_t c) override {
+      if (length + 1 >= sizeof(buffer)) return 0;
+      buffer[length++] = (char) c;
+      buffer[length] = '\0';
+      return 1;
+    }
+
+    using Print::write;
+
+    const char *output() const { return buffer; }
+
+    void clear() {
+      length = 0;
+      buffer[0] = '\0';
+    }
+};
+
+inline HardwareSerial Serial;
+
+class IPAddress : public Printable {
+
+private:
+    uint8_t bytes[4] = {};
+
+public:
+    IPAddress() = default;
+
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) : bytes{first, second, third, fourth} {}
+
+    bool fromString(const char *text) {
+      unsigned int parts[4];
+      char extra;
+      if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &extra) != 4) return false;
+      for (uint8_t i = 0; i < 4; i++) {
+        if (parts[i] > 255) return false;
+        bytes[i] = parts[i];
+      }
+      return true;
+    }
+
+    uint8_t operator[](int index) const { return bytes[index]; }
+
+    bool operator==(const IPAddress &other) const { return memcmp(bytes, other.bytes, sizeof(bytes)) == 0; }
+
+    bool operator!=(const IPAddress &other) const { return !(*this == other); }
+
+    size_t printTo(Print &p) const override {
+      char text[16];
+      snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+      return p.print(text);
+    }
+};
+
+class String {
+
+private:
+    std::string text;
+
+public:
+    String(const char *value = "") : text(value != nullptr ? value : "") {}
+
+    explicit String(char value) : text(1, value) {}
+
+    const char *c_str() const { return text.c_str(); }
+
+    unsigned int length() const { return text.length(); }
+
+    bool isEmpty() const { return text.empty(); }
+
+    String substring(unsigned int from) const { return substring(from, text.length()); }
+
+    String substring(unsigned int from, unsigned int to) const {
+      if (from > to) std::swap(from, to);
+      if (from >= text.length()) return String();
+      return String(text.substr(from, std::min<size_t>(to, text.length()) - from).c_str());
+    }
+
+    bool equals(const char *value) const { return text == value; }
+
+    String &operator+=(const char *value) { text += value; return *this; }
+
+    String &operator+=(const String &value) { text += value.text; return *this; }
+
+    String &operator+=(char value) { text += value; return *this; }
+
+    bool operator==(const char *value) const { return equals(value); }
+
+    bool operator==(const String &value) const { return text == value.text; }
+};
+
+inline size_t Print::print(const String &text) { return write(reinterpret_cast<const uint8_t *>(text.c_str()), text.length()); }
+
+inline String operator+(const String &lhs, const String &rhs) { String result(lhs); result += rhs; return result; }
+
+inline String operator+(const String &lhs, const char *rhs) { String result(lhs); result += rhs; return result; }
+
+inline String operator+(const char *lhs, const String &rhs) { String result(lhs); result += rhs; return result; }
+
+#endif
@@ -0,0 +1,49 @@
+/*
+  HeapCounter.h - Heap allocation counter for the native unit tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#ifndef _DPSOFTWARE_TEST_HEAP_COUNTER_H
+#define _DPSOFTWARE_TEST_HEAP_COUNTER_H
+
+#include <stdlib.h>
+#include <new>
+
+/*
+  Replaces the global operator new and delete of the test binary, String included, include it in one file of a test only.
+  A test reads heapAllocations before and after the code under test.
+*/
+inline size_t heapAllocations = 0;
+
+void *operator new(size_t size) {
+  heapAllocations++;
+  void *ptr = malloc(size > 0 ? size : 1);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete[](void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+#endif
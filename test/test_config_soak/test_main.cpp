@@ -0,0 +1,102 @@
+/*
+  test_main.cpp - BootstrapConfig and FixedString heap fragmentation soak test
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "HeapCounter.h"
+#include "Helpers.h"
+#include "JsonArena.h"
+
+// days of reconnections and MQTT messages, every round touches every field
+#define SOAK_ROUNDS 10000
+
+alignas(8) static uint8_t documentBuffer[8192];
+
+static BootstrapConfig config;
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_assign_and_compare() {
+  String fromString("a network name longer than SSO");
+  FixedString<65> other = "a password longer than the small string buffer";
+  size_t before = heapAllocations;
+  for (uint32_t round = 0; round < SOAK_ROUNDS; round++) {
+    config.qsid = round % 2 == 0 ? "network one" : "a network name that is quite long";
+    config.qsid = fromString;
+    config.qpass = other;
+    config.deviceName = F("living room lights");
+    config.deviceName += "/";
+    config.deviceName += 'x';
+    config.mqttWillTopic.assign("lights/living room lights/LWT");
+    config.lastMQTTConnection = round % 2 == 0 ? "ON" : "OFF";
+    TEST_ASSERT_TRUE(config.qsid == fromString);
+    TEST_ASSERT_TRUE(config.qpass == other.c_str());
+    TEST_ASSERT_TRUE(config.deviceName != "living room lights");
+    TEST_ASSERT_TRUE(config.mqttWillTopic.startsWith("lights/"));
+    TEST_ASSERT_TRUE(config.mqttWillTopic.endsWith("/LWT"));
+    TEST_ASSERT_EQUAL(6, config.mqttWillTopic.indexOf('/'));
+  }
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+}
+
+void test_convert() {
+  size_t before = heapAllocations;
+  for (uint32_t round = 0; round < SOAK_ROUNDS; round++) {
+    config.mqttPort = round % 2 == 0 ? "1883" : "8883";
+    config.mqttIP = "192.168.1.2";
+    config.microcontrollerIP = round % 2 == 0 ? "DHCP" : "192.168.1.20";
+    TEST_ASSERT_EQUAL(round % 2 == 0 ? 1883 : 8883, config.getMqttPort());
+    TEST_ASSERT_TRUE(config.getMqttIp() == IPAddress(192, 168, 1, 2));
+    TEST_ASSERT_EQUAL(round % 2 == 0, config.isDhcp());
+    TEST_ASSERT_EQUAL(round % 2 == 0 ? 0 : 20, config.getMicrocontrollerIp()[3]);
+    TEST_ASSERT_EQUAL(round % 2 == 0 ? 1883 : 8883, config.mqttPort.toInt());
+    config.additionalParam = "  Mixed Case  ";
+    config.additionalParam.trim();
+    config.additionalParam.toUpperCase();
+    TEST_ASSERT_EQUAL_STRING("MIXED CASE", config.additionalParam.c_str());
+  }
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+}
+
+// the setup file is parsed once, its values are read again and again into the config fields
+void test_read_from_json() {
+  JsonArena arena(documentBuffer, sizeof(documentBuffer));
+  JsonDocument doc(&arena);
+  TEST_ASSERT_FALSE(deserializeJson(doc, "{\"qsid\":\"a network name\",\"mqttPort\":1883,\"deviceName\":\"kitchen\"}"));
+  size_t before = heapAllocations;
+  for (uint32_t round = 0; round < SOAK_ROUNDS; round++) {
+    Helpers::readConfig(config.qsid, doc["qsid"], "qsid");
+    Helpers::readConfig(config.mqttPort, doc["mqttPort"], "mqttPort");
+    config.deviceName = doc["deviceName"].as<FixedString<33>>();
+    TEST_ASSERT_EQUAL_STRING("a network name", config.qsid.c_str());
+    TEST_ASSERT_EQUAL_STRING("1883", config.mqttPort.c_str());
+    TEST_ASSERT_EQUAL_STRING("kitchen", config.deviceName.c_str());
+  }
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL(0, arena.getStats().heapFallbacks);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_assign_and_compare);
+  RUN_TEST(test_convert);
+  RUN_TEST(test_read_from_json);
+  return UNITY_END();
+}
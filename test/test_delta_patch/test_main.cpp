@@ -0,0 +1,248 @@
+/*
+  test_main.cpp - Delta patch decoder tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "DeltaPatch.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// patch, old image and new image in memory, the patch is read in chunks of chunkSize bytes
+class MemoryPatch : public DeltaPatch {
+
+private:
+    const Bytes &patch;
+    const Bytes &oldImage;
+    size_t patchOffset = DELTA_PATCH_HEADER;
+    size_t chunkSize;
+
+protected:
+    size_t readPatch(uint8_t *buffer, size_t size) override {
+      if (size > chunkSize) size = chunkSize;
+      if (size > patch.size() - patchOffset) size = patch.size() - patchOffset;
+      memcpy(buffer, patch.data() + patchOffset, size);
+      patchOffset += size;
+      return size;
+    }
+
+    bool readOld(uint32_t offset, uint8_t *data, size_t size) override {
+      if (offset + size > oldImage.size()) return false;
+      memcpy(data, oldImage.data() + offset, size);
+      return true;
+    }
+
+    bool writeNew(const uint8_t *data, size_t size) override {
+      newImage.insert(newImage.end(), data, data + size);
+      return true;
+    }
+
+public:
+    Bytes newImage;
+
+    MemoryPatch(const Bytes &patchBytes, const Bytes &oldBytes, size_t chunk)
+        : patch(patchBytes), oldImage(oldBytes), chunkSize(chunk) {}
+};
+
+static void putVarint(Bytes &out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(value);
+}
+
+static void putUint32(Bytes &out, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++) out.push_back(value >> (i * 8));
+}
+
+static uint32_t zigzag(int32_t value) {
+  return value >= 0 ? (uint32_t) value << 1 : ((uint32_t) -value << 1) - 1;
+}
+
+// MD5 are checked by Update, not by the decoder
+static Bytes header(uint32_t oldSize, uint32_t newSize) {
+  Bytes out = {'D', 'O', 'T', 'A'};
+  putUint32(out, oldSize);
+  putUint32(out, newSize);
+  out.insert(out.end(), 32, 0);
+  return out;
+}
+
+static Bytes oldImage() {
+  Bytes image(1000);
+  uint32_t seed = 12345;
+  for (uint8_t &byte : image) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+  return image;
+}
+
+/*
+  new image: old[0, 300) with 10 changed bytes at 100, 50 new bytes, old[600, 1000), old[0, 100)
+  expected receives the same image built without the decoder
+*/
+static Bytes samplePatch(const Bytes &old, Bytes &expected) {
+  Bytes patch = header(old.size(), 850);
+  expected.assign(old.begin(), old.begin() + 300);
+  // diff of 300 bytes: 100 unchanged, 10 changed, 190 unchanged, then 50 extra bytes, seek from 300 to 600
+  putVarint(patch, 300);
+  putVarint(patch, 50);
+  putVarint(patch, zigzag(300));
+  putVarint(patch, 100);
+  putVarint(patch, 10);
+  for (uint8_t i = 0; i < 10; i++) {
+    patch.push_back(i + 1);
+    expected[100 + i] += i + 1;
+  }
+  putVarint(patch, 190);
+  putVarint(patch, 0);
+  for (uint8_t i = 0; i < 50; i++) {
+    patch.push_back('a' + i % 26);
+    expected.push_back('a' + i % 26);
+  }
+  // old[600, 1000) then back to the start of the old image
+  putVarint(patch, 400);
+  putVarint(patch, 0);
+  putVarint(patch, zigzag(-1000));
+  putVarint(patch, 400);
+  putVarint(patch, 0);
+  expected.insert(expected.end(), old.begin() + 600, old.end());
+  putVarint(patch, 100);
+  putVarint(patch, 0);
+  putVarint(patch, 0);
+  putVarint(patch, 100);
+  putVarint(patch, 0);
+  expected.insert(expected.end(), old.begin(), old.begin() + 100);
+  return patch;
+}
+
+static bool apply(const Bytes &patch, const Bytes &old, size_t chunk, Bytes *result = nullptr) {
+  DeltaPatchHeader parsed;
+  TEST_ASSERT_TRUE(DeltaPatch::parseHeader(patch.data(), parsed));
+  MemoryPatch decoder(patch, old, chunk);
+  bool ok = decoder.apply(parsed);
+  if (result != nullptr) *result = decoder.newImage;
+  return ok;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_header() {
+  Bytes patch = header(1000, 850);
+  patch[12] = 0xAB;
+  patch[43] = 0xCD;
+  DeltaPatchHeader parsed;
+  TEST_ASSERT_TRUE(DeltaPatch::isPatch(patch.data(), 4));
+  TEST_ASSERT_TRUE(DeltaPatch::parseHeader(patch.data(), parsed));
+  TEST_ASSERT_EQUAL_UINT32(1000, parsed.oldSize);
+  TEST_ASSERT_EQUAL_UINT32(850, parsed.newSize);
+  TEST_ASSERT_EQUAL_HEX8(0xAB, parsed.oldMd5[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xCD, parsed.newMd5[15]);
+  patch[0] = 0x1F;
+  TEST_ASSERT_FALSE(DeltaPatch::isPatch(patch.data(), patch.size()));
+  TEST_ASSERT_FALSE(DeltaPatch::parseHeader(patch.data(), parsed));
+  TEST_ASSERT_FALSE(DeltaPatch::isPatch((const uint8_t *) "DOT", 3));
+}
+
+void test_round_trip() {
+  Bytes old = oldImage();
+  Bytes expected;
+  Bytes patch = samplePatch(old, expected);
+  Bytes result;
+  TEST_ASSERT_TRUE(apply(patch, old, DELTA_PATCH_BUFFER, &result));
+  TEST_ASSERT_EQUAL(expected.size(), result.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), result.data(), expected.size());
+}
+
+// the network delivers small chunks, varints and diff bytes are split between reads
+void test_round_trip_small_chunks() {
+  Bytes old = oldImage();
+  Bytes expected;
+  Bytes patch = samplePatch(old, expected);
+  for (size_t chunk : {1u, 3u, 7u, 64u}) {
+    Bytes result;
+    TEST_ASSERT_TRUE(apply(patch, old, chunk, &result));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), result.data(), expected.size());
+  }
+}
+
+void test_truncated_patch() {
+  Bytes old = oldImage();
+  Bytes expected;
+  Bytes patch = samplePatch(old, expected);
+  for (size_t length : {(size_t) DELTA_PATCH_HEADER + 1, (size_t) DELTA_PATCH_HEADER + 20, patch.size() - 1}) {
+    Bytes truncated(patch.begin(), patch.begin() + length);
+    TEST_ASSERT_FALSE(apply(truncated, old, 16));
+  }
+}
+
+void test_seek_outside_old_image() {
+  Bytes old = oldImage();
+  Bytes patch = header(old.size(), 20);
+  putVarint(patch, 10);
+  putVarint(patch, 0);
+  putVarint(patch, zigzag(-100));
+  putVarint(patch, 10);
+  putVarint(patch, 0);
+  putVarint(patch, 10);
+  putVarint(patch, 0);
+  putVarint(patch, 0);
+  putVarint(patch, 10);
+  putVarint(patch, 0);
+  TEST_ASSERT_FALSE(apply(patch, old, 16));
+}
+
+void test_run_longer_than_diff() {
+  Bytes old = oldImage();
+  Bytes patch = header(old.size(), 20);
+  putVarint(patch, 10);
+  putVarint(patch, 0);
+  putVarint(patch, 0);
+  putVarint(patch, 8);
+  putVarint(patch, 0xFFFFFFFF);
+  TEST_ASSERT_FALSE(apply(patch, old, 16));
+}
+
+void test_patch_longer_than_new_image() {
+  Bytes old = oldImage();
+  Bytes patch = header(old.size(), 10);
+  putVarint(patch, 0);
+  putVarint(patch, 20);
+  putVarint(patch, 0);
+  patch.insert(patch.end(), 20, 'x');
+  Bytes result;
+  TEST_ASSERT_FALSE(apply(patch, old, 16, &result));
+  TEST_ASSERT_TRUE(result.size() <= 10);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_header);
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_round_trip_small_chunks);
+  RUN_TEST(test_truncated_patch);
+  RUN_TEST(test_seek_outside_old_image);
+  RUN_TEST(test_run_longer_than_diff);
+  RUN_TEST(test_patch_longer_than_new_image);
+  return UNITY_END();
+}
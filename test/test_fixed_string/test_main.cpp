@@ -0,0 +1,122 @@
+/*
+  test_main.cpp - FixedString tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "FixedString.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_truncation() {
+  FixedString<6> value;
+  TEST_ASSERT_TRUE(value.isEmpty());
+  TEST_ASSERT_TRUE(value.assign("short"));
+  TEST_ASSERT_FALSE(value.assign("too long"));
+  TEST_ASSERT_EQUAL_STRING("too l", value.c_str());
+  TEST_ASSERT_EQUAL(5, value.length());
+  TEST_ASSERT_EQUAL(5, FixedString<6>::capacity());
+  TEST_ASSERT_TRUE(value.assign(nullptr));
+  TEST_ASSERT_EQUAL_STRING("", value.c_str());
+}
+
+void test_concat() {
+  FixedString<8> value = "ab";
+  value += "cd";
+  value += String("ef");
+  value += 'g';
+  TEST_ASSERT_EQUAL_STRING("abcdefg", value.c_str());
+  TEST_ASSERT_FALSE(value.concat("hi"));
+  TEST_ASSERT_EQUAL_STRING("abcdefg", value.c_str());
+}
+
+void test_assignment_and_comparison() {
+  FixedString<16> value;
+  value = String("device");
+  TEST_ASSERT_TRUE(value == "device");
+  TEST_ASSERT_TRUE(value == String("device"));
+  TEST_ASSERT_TRUE(value != "other");
+  FixedString<4> small;
+  small = value;
+  TEST_ASSERT_EQUAL_STRING("dev", small.c_str());
+  value = F("flash");
+  TEST_ASSERT_EQUAL_STRING("flash", value.c_str());
+}
+
+void test_search() {
+  FixedString<32> value = "broker.lan:1883";
+  TEST_ASSERT_EQUAL(6, value.indexOf('.'));
+  TEST_ASSERT_EQUAL(-1, value.indexOf('.', 7));
+  TEST_ASSERT_EQUAL(11, value.indexOf("1883"));
+  TEST_ASSERT_EQUAL(10, value.lastIndexOf(':'));
+  TEST_ASSERT_EQUAL(-1, value.lastIndexOf('#'));
+  TEST_ASSERT_TRUE(value.startsWith("broker"));
+  TEST_ASSERT_TRUE(value.endsWith("1883"));
+  TEST_ASSERT_FALSE(value.endsWith("a longer suffix than the value"));
+  TEST_ASSERT_EQUAL('b', value.charAt(0));
+  TEST_ASSERT_EQUAL('\0', value[40]);
+}
+
+void test_conversions() {
+  FixedString<16> value = "  MiXeD  ";
+  value.trim();
+  TEST_ASSERT_EQUAL_STRING("MiXeD", value.c_str());
+  value.toUpperCase();
+  TEST_ASSERT_EQUAL_STRING("MIXED", value.c_str());
+  value.toLowerCase();
+  TEST_ASSERT_EQUAL_STRING("mixed", value.c_str());
+  TEST_ASSERT_EQUAL_STRING("ix", value.substring(1, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING("xed", value.substring(2).c_str());
+  value = "1883";
+  TEST_ASSERT_EQUAL(1883, value.toInt());
+  value = "2.5";
+  TEST_ASSERT_EQUAL_FLOAT(2.5f, value.toFloat());
+}
+
+void test_string_concatenation() {
+  FixedString<16> name = "kitchen";
+  String topic = "lights/" + name;
+  TEST_ASSERT_EQUAL_STRING("lights/kitchen", topic.c_str());
+  topic = String("lights/") + name + "/set";
+  TEST_ASSERT_EQUAL_STRING("lights/kitchen/set", topic.c_str());
+  topic = name + String("/state");
+  TEST_ASSERT_EQUAL_STRING("kitchen/state", topic.c_str());
+}
+
+void test_json_conversion() {
+  JsonDocument doc;
+  FixedString<16> name = "kitchen";
+  doc["deviceName"] = name;
+  TEST_ASSERT_EQUAL_STRING("kitchen", doc["deviceName"].as<const char *>());
+  doc["deviceName"] = "a name longer than the buffer";
+  FixedString<16> read = doc["deviceName"].as<FixedString<16>>();
+  TEST_ASSERT_EQUAL_STRING("a name longer t", read.c_str());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_truncation);
+  RUN_TEST(test_concat);
+  RUN_TEST(test_assignment_and_comparison);
+  RUN_TEST(test_search);
+  RUN_TEST(test_conversions);
+  RUN_TEST(test_string_concatenation);
+  RUN_TEST(test_json_conversion);
+  return UNITY_END();
+}
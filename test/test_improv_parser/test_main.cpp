@@ -0,0 +1,298 @@
+/*
+  test_main.cpp - Improv Serial and DPSETH parser tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "ImprovParser.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// IMPROV header, version, RPC command, length, command, data length, data, checksum
+static Bytes improvPacket(uint8_t command, const std::string &data) {
+  Bytes packet = {'I', 'M', 'P', 'R', 'O', 'V', IMPROV_VERSION, RPC_Command, (uint8_t) (data.size() + 2), command,
+                  (uint8_t) data.size()};
+  packet.insert(packet.end(), data.begin(), data.end());
+  uint8_t checksum = 0;
+  for (uint8_t byte : packet) checksum += byte;
+  packet.push_back(checksum);
+  return packet;
+}
+
+static void addField(Bytes &fields, uint8_t type, const std::string &value) {
+  fields.push_back(type);
+  fields.push_back((uint8_t) value.size());
+  fields.insert(fields.end(), value.begin(), value.end());
+}
+
+// version, length and CRC around the fields, the DPSETH header is fed to ImprovParser
+static Bytes dpsethPacket(const Bytes &fields) {
+  Bytes packet = {DPSETH_VERSION, (uint8_t) (fields.size() >> 8), (uint8_t) fields.size()};
+  packet.insert(packet.end(), fields.begin(), fields.end());
+  uint16_t crc = 0xFFFF;
+  for (uint8_t byte : packet) crc = DpsethParser::crc16(crc, byte);
+  packet.push_back(crc >> 8);
+  packet.push_back(crc & 0xFF);
+  return packet;
+}
+
+// feed every byte, returns the events that are not Improv_None in order
+static Bytes feedImprov(ImprovParser &parser, const Bytes &bytes) {
+  Bytes events;
+  for (uint8_t byte : bytes) {
+    uint8_t event = parser.feed(byte);
+    if (event != Improv_None) events.push_back(event);
+  }
+  return events;
+}
+
+static uint8_t feedDpseth(DpsethParser &parser, const Bytes &bytes) {
+  uint8_t last = Dpseth_None;
+  for (uint8_t byte : bytes) {
+    last = parser.feed(byte);
+    if (last != Dpseth_None) break;
+  }
+  return last;
+}
+
+static std::string text(const DpsethRecord &field) {
+  return std::string(field.value, field.length);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_improv_rpc_command() {
+  ImprovParser parser;
+  Bytes events = feedImprov(parser, improvPacket(Command_Wifi, "\x04home\x06secret"));
+  TEST_ASSERT_EQUAL(2, events.size());
+  TEST_ASSERT_EQUAL(Improv_Rpc_Started, events[0]);
+  TEST_ASSERT_EQUAL(Improv_Rpc_Command, events[1]);
+  TEST_ASSERT_EQUAL(Command_Wifi, parser.getRpcCommandType());
+  TEST_ASSERT_EQUAL_STRING("\x0c\x04home\x06secret", parser.getRpcData());
+  TEST_ASSERT_FALSE(parser.isReceiving());
+}
+
+// bytes arrive in several loops, the state is kept between them
+void test_improv_fragmented_packet() {
+  ImprovParser parser;
+  Bytes packet = improvPacket(Request_Info, "");
+  Bytes first(packet.begin(), packet.begin() + 5);
+  Bytes second(packet.begin() + 5, packet.end() - 1);
+  TEST_ASSERT_EQUAL(0, feedImprov(parser, first).size());
+  TEST_ASSERT_TRUE(parser.isReceiving());
+  TEST_ASSERT_EQUAL(1, feedImprov(parser, second).size());
+  TEST_ASSERT_EQUAL(Improv_Rpc_Command, parser.feed(packet.back()));
+  TEST_ASSERT_EQUAL(Request_Info, parser.getRpcCommandType());
+}
+
+void test_improv_skips_noise_before_header() {
+  ImprovParser parser;
+  Bytes bytes = {'h', 'e', 'l', 'l', 'o', '\n', 'I', 'M', 'X'};
+  Bytes packet = improvPacket(Request_State, "");
+  bytes.insert(bytes.end(), packet.begin(), packet.end());
+  Bytes events = feedImprov(parser, bytes);
+  TEST_ASSERT_EQUAL(Improv_Rpc_Command, events.back());
+  TEST_ASSERT_EQUAL(Request_State, parser.getRpcCommandType());
+}
+
+void test_improv_bad_checksum() {
+  ImprovParser parser;
+  Bytes packet = improvPacket(Command_Wifi, "\x04home");
+  packet.back()++;
+  Bytes events = feedImprov(parser, packet);
+  TEST_ASSERT_EQUAL(Improv_Bad_Checksum, events.back());
+  TEST_ASSERT_FALSE(parser.isReceiving());
+  // the next packet is parsed
+  events = feedImprov(parser, improvPacket(Request_Info, ""));
+  TEST_ASSERT_EQUAL(Improv_Rpc_Command, events.back());
+}
+
+void test_improv_invalid_version_and_type() {
+  ImprovParser parser;
+  Bytes packet = improvPacket(Request_Info, "");
+  packet[Version] = IMPROV_VERSION + 1;
+  Bytes events = feedImprov(parser, Bytes(packet.begin(), packet.begin() + Version + 1));
+  TEST_ASSERT_EQUAL(1, events.size());
+  TEST_ASSERT_EQUAL(Improv_Invalid, events[0]);
+  TEST_ASSERT_FALSE(parser.isReceiving());
+
+  packet = improvPacket(Request_Info, "");
+  packet[PacketType] = Current_State;
+  events = feedImprov(parser, Bytes(packet.begin(), packet.begin() + PacketType + 1));
+  TEST_ASSERT_EQUAL(1, events.size());
+  TEST_ASSERT_EQUAL(Improv_Invalid, events[0]);
+}
+
+void test_improv_oversized_data() {
+  ImprovParser parser;
+  Bytes events = feedImprov(parser, improvPacket(Command_Wifi, std::string(200, 'x')));
+  TEST_ASSERT_EQUAL(Improv_Invalid, events[1]);
+}
+
+void test_improv_dpseth_header() {
+  ImprovParser parser;
+  Bytes events = feedImprov(parser, {'D', 'P', 'S', 'E', 'T', 'H'});
+  TEST_ASSERT_EQUAL(1, events.size());
+  TEST_ASSERT_EQUAL(Improv_Dpseth_Header, events[0]);
+  TEST_ASSERT_FALSE(parser.isReceiving());
+}
+
+void test_crc16_check_value() {
+  uint16_t crc = 0xFFFF;
+  for (const char *c = "123456789"; *c; c++) crc = DpsethParser::crc16(crc, *c);
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc);
+}
+
+void test_dpseth_fields() {
+  Bytes fields;
+  addField(fields, Field_Device_Name, "kitchen");
+  addField(fields, 0x7F, "unknown");
+  addField(fields, Field_Mqtt_Broker, "broker.lan:1884");
+  addField(fields, Field_Qpass, "");
+  DpsethParser parser;
+  parser.start();
+  TEST_ASSERT_EQUAL(Dpseth_Received, feedDpseth(parser, dpsethPacket(fields)));
+  TEST_ASSERT_FALSE(parser.isActive());
+
+  uint16_t pos = 0;
+  DpsethRecord field;
+  TEST_ASSERT_EQUAL(Field_Read, parser.nextField(pos, field));
+  TEST_ASSERT_EQUAL(Field_Device_Name, field.type);
+  TEST_ASSERT_EQUAL_STRING("kitchen", text(field).c_str());
+  TEST_ASSERT_EQUAL(Field_Read, parser.nextField(pos, field));
+  TEST_ASSERT_NULL(DpsethParser::fieldName(field.type));
+  TEST_ASSERT_EQUAL(Field_Read, parser.nextField(pos, field));
+  TEST_ASSERT_EQUAL_STRING("brokers", DpsethParser::fieldName(field.type));
+  TEST_ASSERT_EQUAL(10, DpsethParser::brokerPortSeparator(field.value, field.length));
+  TEST_ASSERT_EQUAL(Field_Read, parser.nextField(pos, field));
+  TEST_ASSERT_EQUAL(Field_Qpass, field.type);
+  TEST_ASSERT_EQUAL(0, field.length);
+  TEST_ASSERT_EQUAL(Field_End, parser.nextField(pos, field));
+}
+
+void test_dpseth_through_improv_parser_one_byte_per_loop() {
+  Bytes fields;
+  addField(fields, Field_Qsid, "home");
+  Bytes bytes = {'D', 'P', 'S', 'E', 'T', 'H'};
+  Bytes packet = dpsethPacket(fields);
+  bytes.insert(bytes.end(), packet.begin(), packet.end());
+  ImprovParser improv;
+  DpsethParser dpseth;
+  uint8_t last = Dpseth_None;
+  for (uint8_t byte : bytes) {
+    if (dpseth.isActive()) {
+      last = dpseth.feed(byte);
+    } else if (improv.feed(byte) == Improv_Dpseth_Header) {
+      dpseth.start();
+    }
+  }
+  TEST_ASSERT_EQUAL(Dpseth_Received, last);
+  uint16_t pos = 0;
+  DpsethRecord field;
+  TEST_ASSERT_EQUAL(Field_Read, dpseth.nextField(pos, field));
+  TEST_ASSERT_EQUAL_STRING("home", text(field).c_str());
+}
+
+void test_dpseth_bad_crc() {
+  Bytes fields;
+  addField(fields, Field_Qsid, "home");
+  Bytes packet = dpsethPacket(fields);
+  packet[5] ^= 0x01;
+  DpsethParser parser;
+  parser.start();
+  TEST_ASSERT_EQUAL(Dpseth_Bad_Crc, feedDpseth(parser, packet));
+  TEST_ASSERT_FALSE(parser.isActive());
+}
+
+void test_dpseth_too_big() {
+  DpsethParser parser;
+  parser.start();
+  Bytes header = {DPSETH_VERSION, (DPSETH_MAX_PAYLOAD + 1) >> 8, (DPSETH_MAX_PAYLOAD + 1) & 0xFF};
+  TEST_ASSERT_EQUAL(Dpseth_Too_Big, feedDpseth(parser, header));
+  TEST_ASSERT_FALSE(parser.isActive());
+}
+
+// the CRC is valid but the last field is longer than the packet
+void test_dpseth_truncated_field() {
+  Bytes fields;
+  addField(fields, Field_Qsid, "home");
+  fields.push_back(Field_Qpass);
+  fields.push_back(10);
+  fields.push_back('x');
+  DpsethParser parser;
+  parser.start();
+  TEST_ASSERT_EQUAL(Dpseth_Received, feedDpseth(parser, dpsethPacket(fields)));
+  uint16_t pos = 0;
+  DpsethRecord field;
+  TEST_ASSERT_EQUAL(Field_Read, parser.nextField(pos, field));
+  TEST_ASSERT_EQUAL(Field_Truncated, parser.nextField(pos, field));
+}
+
+void test_dpseth_legacy_packet() {
+  std::string lines = "unused\nkitchen\n192.168.1.50\nhome\nsecret\n";
+  lines += std::string(70, 'o') + "\n";
+  for (uint8_t i = 6; i < DPSETH_LEGACY_FIELDS; i++) lines += "v" + std::to_string(i) + "\n";
+  DpsethParser parser;
+  parser.start();
+  TEST_ASSERT_EQUAL(Dpseth_Legacy_Received, feedDpseth(parser, Bytes(lines.begin(), lines.end())));
+
+  uint16_t pos = 0;
+  uint8_t line = 0;
+  DpsethRecord field;
+  std::vector<DpsethRecord> read;
+  while (parser.nextLegacyField(pos, line, field)) read.push_back(field);
+  TEST_ASSERT_EQUAL(DPSETH_LEGACY_FIELDS, read.size());
+  TEST_ASSERT_NULL(DpsethParser::fieldName(read[0].type));
+  TEST_ASSERT_EQUAL(Field_Device_Name, read[1].type);
+  TEST_ASSERT_EQUAL_STRING("kitchen", text(read[1]).c_str());
+  TEST_ASSERT_EQUAL(Field_Qsid, read[3].type);
+  TEST_ASSERT_EQUAL_STRING("home", text(read[3]).c_str());
+  TEST_ASSERT_EQUAL(Field_OTA_Pass, read[5].type);
+  TEST_ASSERT_EQUAL(DPSETH_LEGACY_FIELD_SIZE, read[5].length);
+  TEST_ASSERT_EQUAL(Field_Eth_Cs, read[14].type);
+  TEST_ASSERT_EQUAL_STRING("v14", text(read[14]).c_str());
+}
+
+void test_broker_port_separator() {
+  TEST_ASSERT_EQUAL(-1, DpsethParser::brokerPortSeparator("broker.lan", 10));
+  TEST_ASSERT_EQUAL(3, DpsethParser::brokerPortSeparator("::1:1883", 8));
+  TEST_ASSERT_EQUAL(-1, DpsethParser::brokerPortSeparator("", 0));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_improv_rpc_command);
+  RUN_TEST(test_improv_fragmented_packet);
+  RUN_TEST(test_improv_skips_noise_before_header);
+  RUN_TEST(test_improv_bad_checksum);
+  RUN_TEST(test_improv_invalid_version_and_type);
+  RUN_TEST(test_improv_oversized_data);
+  RUN_TEST(test_improv_dpseth_header);
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_dpseth_fields);
+  RUN_TEST(test_dpseth_through_improv_parser_one_byte_per_loop);
+  RUN_TEST(test_dpseth_bad_crc);
+  RUN_TEST(test_dpseth_too_big);
+  RUN_TEST(test_dpseth_truncated_field);
+  RUN_TEST(test_dpseth_legacy_packet);
+  RUN_TEST(test_broker_port_separator);
+  return UNITY_END();
+}
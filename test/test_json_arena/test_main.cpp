@@ -0,0 +1,131 @@
+/*
+  test_main.cpp - JsonArena tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "JsonArena.h"
+
+alignas(8) static uint8_t buffer[256];
+// a variant pool of ArduinoJson takes 4 KB on 64 bit hosts
+alignas(8) static uint8_t documentBuffer[8192];
+
+static bool inArena(const void *ptr) {
+  return ptr >= buffer && ptr < buffer + sizeof(buffer);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_blocks_are_carved_in_order() {
+  JsonArena arena(buffer, sizeof(buffer));
+  uint8_t *first = (uint8_t *) arena.allocate(10);
+  uint8_t *second = (uint8_t *) arena.allocate(20);
+  TEST_ASSERT_TRUE(inArena(first));
+  TEST_ASSERT_TRUE(inArena(second));
+  // 8 bytes of header, 10 bytes rounded to 16
+  TEST_ASSERT_EQUAL(24, second - first);
+  TEST_ASSERT_EQUAL(2, arena.getStats().allocations);
+  TEST_ASSERT_EQUAL(56, arena.getStats().used);
+}
+
+void test_rewind_when_every_block_is_freed() {
+  JsonArena arena(buffer, sizeof(buffer));
+  void *first = arena.allocate(10);
+  void *second = arena.allocate(20);
+  arena.deallocate(first);
+  TEST_ASSERT_EQUAL(0, arena.getStats().rewinds);
+  arena.deallocate(second);
+  TEST_ASSERT_EQUAL(1, arena.getStats().rewinds);
+  TEST_ASSERT_EQUAL(0, arena.getStats().used);
+  TEST_ASSERT_EQUAL(56, arena.getStats().peak);
+  TEST_ASSERT_EQUAL_PTR(first, arena.allocate(10));
+}
+
+void test_last_block_grows_in_place() {
+  JsonArena arena(buffer, sizeof(buffer));
+  arena.allocate(8);
+  char *last = (char *) arena.allocate(8);
+  strcpy(last, "abcdefg");
+  TEST_ASSERT_EQUAL_PTR(last, arena.reallocate(last, 100));
+  TEST_ASSERT_EQUAL_STRING("abcdefg", last);
+  TEST_ASSERT_EQUAL_PTR(last, arena.reallocate(last, 4));
+  TEST_ASSERT_EQUAL(32, arena.getStats().used);
+}
+
+// a block that isn't the last one is moved when it grows
+void test_inner_block_is_moved() {
+  JsonArena arena(buffer, sizeof(buffer));
+  char *inner = (char *) arena.allocate(8);
+  arena.allocate(8);
+  strcpy(inner, "inner");
+  char *moved = (char *) arena.reallocate(inner, 40);
+  TEST_ASSERT_TRUE(moved != inner);
+  TEST_ASSERT_TRUE(inArena(moved));
+  TEST_ASSERT_EQUAL_STRING("inner", moved);
+}
+
+void test_heap_fallback() {
+  JsonArena arena(buffer, sizeof(buffer));
+  void *big = arena.allocate(sizeof(buffer));
+  TEST_ASSERT_NOT_NULL(big);
+  TEST_ASSERT_FALSE(inArena(big));
+  TEST_ASSERT_EQUAL(1, arena.getStats().heapFallbacks);
+  void *small = arena.allocate(16);
+  TEST_ASSERT_TRUE(inArena(small));
+  // the last arena block can't grow past the buffer, it moves to the heap
+  void *grown = arena.reallocate(small, sizeof(buffer));
+  TEST_ASSERT_FALSE(inArena(grown));
+  TEST_ASSERT_EQUAL(1, arena.getStats().rewinds);
+  arena.deallocate(big);
+  arena.deallocate(grown);
+}
+
+void test_disabled_arena_uses_the_heap() {
+  JsonArena arena(buffer, 0);
+  void *ptr = arena.allocate(8);
+  TEST_ASSERT_FALSE(inArena(ptr));
+  arena.deallocate(ptr);
+  TEST_ASSERT_EQUAL(1, arena.getStats().heapFallbacks);
+}
+
+// a document parsed and released again and again never leaves the arena
+void test_document_in_arena() {
+  JsonArena arena(documentBuffer, sizeof(documentBuffer));
+  for (uint8_t i = 0; i < 3; i++) {
+    JsonDocument doc(&arena);
+    TEST_ASSERT_FALSE(deserializeJson(doc, "{\"state\":\"ON\",\"brightness\":255,\"color\":{\"r\":255}}"));
+    TEST_ASSERT_EQUAL_STRING("ON", doc["state"].as<const char *>());
+    TEST_ASSERT_EQUAL(255, doc["color"]["r"].as<int>());
+  }
+  TEST_ASSERT_EQUAL(0, arena.getStats().heapFallbacks);
+  TEST_ASSERT_GREATER_OR_EQUAL(3, arena.getStats().rewinds);
+  TEST_ASSERT_EQUAL(0, arena.getStats().used);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_blocks_are_carved_in_order);
+  RUN_TEST(test_rewind_when_every_block_is_freed);
+  RUN_TEST(test_last_block_grows_in_place);
+  RUN_TEST(test_inner_block_is_moved);
+  RUN_TEST(test_heap_fallback);
+  RUN_TEST(test_disabled_arena_uses_the_heap);
+  RUN_TEST(test_document_in_arena);
+  return UNITY_END();
+}
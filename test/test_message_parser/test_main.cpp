@@ -0,0 +1,112 @@
+/*
+  test_main.cpp - MessageParser allocation tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "MessageParser.h"
+
+// counts the allocator calls of the document, the copies returned by value use the same allocator
+class CountingAllocator : public ArduinoJson::Allocator {
+
+public:
+    size_t calls = 0;
+
+    void *allocate(size_t size) override {
+      calls++;
+      return malloc(size);
+    }
+
+    void deallocate(void *ptr) override { free(ptr); }
+
+    void *reallocate(void *ptr, size_t size) override {
+      calls++;
+      return realloc(ptr, size);
+    }
+};
+
+static const char *const MESSAGE = "{\"state\":\"ON\",\"brightness\":255,\"color\":{\"r\":255,\"g\":120,\"b\":0},\"effect\":\"rainbow\"}";
+
+static CountingAllocator allocator;
+static JsonDocument doc(&allocator);
+static MessageParser parser(doc);
+
+// allocator calls of a bare deserializeJson() of the message, what any parser has to pay
+static size_t parseCalls() {
+  size_t before = allocator.calls;
+  TEST_ASSERT_FALSE(deserializeJson(doc, MESSAGE, strlen(MESSAGE)));
+  return allocator.calls - before;
+}
+
+void setUp() {
+  doc.clear();
+}
+
+void tearDown() {}
+
+void test_queue_ref_costs_only_the_parse() {
+  size_t expected = parseCalls();
+  size_t before = allocator.calls;
+  JsonVariantConst message = parser.parseQueueMsgRef("lights/set", (const byte *) MESSAGE, strlen(MESSAGE));
+  TEST_ASSERT_EQUAL(expected, allocator.calls - before);
+  TEST_ASSERT_EQUAL_STRING("ON", message["state"].as<const char *>());
+  TEST_ASSERT_EQUAL(120, message["color"]["g"].as<int>());
+}
+
+void test_http_ref_costs_only_the_parse() {
+  size_t expected = parseCalls();
+  String payload(MESSAGE);
+  size_t before = allocator.calls;
+  JsonVariantConst message = parser.parseHttpMsgRef(MESSAGE, strlen(MESSAGE));
+  TEST_ASSERT_EQUAL(expected, allocator.calls - before);
+  TEST_ASSERT_EQUAL(255, message["brightness"].as<int>());
+  before = allocator.calls;
+  message = parser.parseHttpMsgRef(payload);
+  TEST_ASSERT_EQUAL(expected, allocator.calls - before);
+  TEST_ASSERT_EQUAL_STRING("rainbow", message["effect"].as<const char *>());
+}
+
+// the old by-value parser pays the parse plus a deep copy of the document
+void test_by_value_copies_the_document() {
+  size_t expected = parseCalls();
+  char topic[] = "lights/set";
+  byte payload[128];
+  memcpy(payload, MESSAGE, strlen(MESSAGE));
+  size_t before = allocator.calls;
+  {
+    JsonDocument copy = parser.parseQueueMsg(topic, payload, strlen(MESSAGE));
+    TEST_ASSERT_EQUAL_STRING("ON", copy["state"].as<const char *>());
+  }
+  size_t byValueCalls = allocator.calls - before;
+  TEST_ASSERT_GREATER_THAN(expected, byValueCalls);
+  printf("allocator calls per message: ref %u, by value %u\n", (unsigned) expected, (unsigned) byValueCalls);
+}
+
+void test_non_json_message() {
+  const char *payload = "ON";
+  JsonVariantConst message = parser.parseQueueMsgRef("lights/set", (const byte *) payload, strlen(payload));
+  TEST_ASSERT_EQUAL_STRING("ON", message["value"].as<const char *>());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_queue_ref_costs_only_the_parse);
+  RUN_TEST(test_http_ref_costs_only_the_parse);
+  RUN_TEST(test_by_value_copies_the_document);
+  RUN_TEST(test_non_json_message);
+  return UNITY_END();
+}
@@ -0,0 +1,107 @@
+/*
+  test_main.cpp - Helpers::smartPrint heap allocation tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "HeapCounter.h"
+#include "Helpers.h"
+
+// longer than the small string buffer of String, a temporary String would allocate
+static const char *const LONG_TEXT = "Max retry reached, powering off peripherals.";
+
+void setUp() {
+  Serial.clear();
+}
+
+void tearDown() {}
+
+// the counter sees the allocation of a temporary String, the tests below would catch a regression
+void test_counter_sees_strings() {
+  size_t before = heapAllocations;
+  String temporary(LONG_TEXT);
+  TEST_ASSERT_EQUAL(1, heapAllocations - before);
+}
+
+void test_flash_and_c_strings() {
+  size_t before = heapAllocations;
+  Helpers::smartPrintln(F("Max retry reached, powering off peripherals."));
+  Helpers::smartPrint(LONG_TEXT);
+  Helpers::smartPrintln();
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL_STRING("Max retry reached, powering off peripherals.\r\n"
+                           "Max retry reached, powering off peripherals.\r\n", Serial.output());
+}
+
+void test_numbers() {
+  size_t before = heapAllocations;
+  Helpers::smartPrint(F("Wifi attemps= "));
+  Helpers::smartPrintln(42);
+  Helpers::smartPrintln(4000000000UL);
+  Helpers::smartPrintln(-7L);
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL_STRING("Wifi attemps= 42\r\n4000000000\r\n-7\r\n", Serial.output());
+}
+
+void test_printable() {
+  IPAddress ip(192, 168, 1, 10);
+  FixedString<33> name = "a device name longer than SSO";
+  size_t before = heapAllocations;
+  Helpers::smartPrintln(ip);
+  Helpers::smartPrintln(name);
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL_STRING("192.168.1.10\r\na device name longer than SSO\r\n", Serial.output());
+}
+
+// a String argument is passed by reference, not copied
+void test_string_is_not_copied() {
+  String message(LONG_TEXT);
+  size_t before = heapAllocations;
+  Helpers::smartPrintln(message);
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+}
+
+void test_printf() {
+  size_t before = heapAllocations;
+  Helpers::smartPrintf(PSTR("[%s] written correctly\n"), "setup.json");
+  Helpers::smartPrintf(PSTR("%d attempts"), 3);
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL_STRING("[setup.json] written correctly\n3 attempts", Serial.output());
+}
+
+// the output is formatted into a 128 bytes stack buffer
+void test_printf_truncation() {
+  char longValue[200];
+  memset(longValue, 'x', sizeof(longValue) - 1);
+  longValue[sizeof(longValue) - 1] = '\0';
+  size_t before = heapAllocations;
+  Helpers::smartPrintf(PSTR("%s"), longValue);
+  TEST_ASSERT_EQUAL(0, heapAllocations - before);
+  TEST_ASSERT_EQUAL(127, strlen(Serial.output()));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counter_sees_strings);
+  RUN_TEST(test_flash_and_c_strings);
+  RUN_TEST(test_numbers);
+  RUN_TEST(test_printable);
+  RUN_TEST(test_string_is_not_copied);
+  RUN_TEST(test_printf);
+  RUN_TEST(test_printf_truncation);
+  return UNITY_END();
+}
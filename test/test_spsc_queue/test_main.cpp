@@ -0,0 +1,97 @@
+/*
+  test_main.cpp - SpscQueue tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "SpscQueue.h"
+
+static bool push(SpscQueue<uint32_t, 4> &queue, uint32_t value) {
+  uint32_t *slot = queue.acquire();
+  if (slot == nullptr) return false;
+  *slot = value;
+  queue.commit();
+  return true;
+}
+
+static bool pop(SpscQueue<uint32_t, 4> &queue, uint32_t &value) {
+  uint32_t *slot = queue.peek();
+  if (slot == nullptr) return false;
+  value = *slot;
+  queue.release();
+  return true;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_empty_queue() {
+  SpscQueue<uint32_t, 4> queue;
+  uint32_t value;
+  TEST_ASSERT_EQUAL(0, queue.size());
+  TEST_ASSERT_EQUAL(4, queue.capacity());
+  TEST_ASSERT_NULL(queue.peek());
+  TEST_ASSERT_FALSE(pop(queue, value));
+}
+
+void test_full_queue() {
+  SpscQueue<uint32_t, 4> queue;
+  for (uint32_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(push(queue, i));
+  TEST_ASSERT_EQUAL(4, queue.size());
+  TEST_ASSERT_NULL(queue.acquire());
+  uint32_t value;
+  TEST_ASSERT_TRUE(pop(queue, value));
+  TEST_ASSERT_EQUAL(0, value);
+  TEST_ASSERT_TRUE(push(queue, 4));
+  TEST_ASSERT_NULL(queue.acquire());
+}
+
+// an acquired slot is not visible until it is committed
+void test_commit_publishes_slot() {
+  SpscQueue<uint32_t, 4> queue;
+  uint32_t *slot = queue.acquire();
+  TEST_ASSERT_NOT_NULL(slot);
+  *slot = 7;
+  TEST_ASSERT_NULL(queue.peek());
+  queue.commit();
+  TEST_ASSERT_NOT_NULL(queue.peek());
+  TEST_ASSERT_EQUAL(7, *queue.peek());
+}
+
+// the indexes run past the slots many times, the order is kept
+void test_fifo_order_across_wrap_around() {
+  SpscQueue<uint32_t, 4> queue;
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  for (uint32_t round = 0; round < 100; round++) {
+    for (uint32_t i = 0; i < 1 + round % 4; i++) TEST_ASSERT_TRUE(push(queue, next++));
+    uint32_t value;
+    while (pop(queue, value)) TEST_ASSERT_EQUAL(expected++, value);
+  }
+  TEST_ASSERT_EQUAL(next, expected);
+  TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_queue);
+  RUN_TEST(test_full_queue);
+  RUN_TEST(test_commit_publishes_slot);
+  RUN_TEST(test_fifo_order_across_wrap_around);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+/*
+  test_main.cpp - TaskScheduler tests
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+*/
+
+#include <unity.h>
+#include "TaskScheduler.h"
+
+static uint32_t firstRuns = 0;
+static uint32_t secondRuns = 0;
+static unsigned long taskMicros = 0;
+
+static void firstTask() { firstRuns++; }
+
+static void secondTask() { secondRuns++; }
+
+// a task that takes taskMicros to run
+static void slowTask() {
+  firstRuns++;
+  fakeMicros += taskMicros;
+}
+
+// move the clock one tick at a time, running the scheduler like bootstrapLoop() does
+static void advance(unsigned long ms) {
+  for (unsigned long elapsed = 0; elapsed < ms; elapsed += SCHEDULER_TICK) {
+    fakeMillis += SCHEDULER_TICK;
+    TaskScheduler::run();
+  }
+}
+
+void setUp() {
+  firstRuns = 0;
+  secondRuns = 0;
+  taskMicros = 0;
+}
+
+// every id of every generation is cancelled, a full revolution visits every slot and releases them
+void tearDown() {
+  for (int16_t id = 0; id < INT16_MAX; id++) TaskScheduler::cancel(id);
+  advance(SCHEDULER_WHEEL_SLOTS * SCHEDULER_TICK);
+}
+
+void test_periodic_task() {
+  int16_t id = TaskScheduler::every(100, firstTask);
+  TEST_ASSERT_TRUE(id >= 0);
+  advance(90);
+  TEST_ASSERT_EQUAL(0, firstRuns);
+  advance(10);
+  TEST_ASSERT_EQUAL(1, firstRuns);
+  advance(900);
+  TEST_ASSERT_EQUAL(10, firstRuns);
+  TEST_ASSERT_EQUAL(10, TaskScheduler::getStats(id)->runs);
+}
+
+// intervals longer than a wheel revolution wait in their slot for the right tick
+void test_interval_longer_than_wheel() {
+  unsigned long interval = SCHEDULER_WHEEL_SLOTS * SCHEDULER_TICK * 3 + SCHEDULER_TICK * 5;
+  TaskScheduler::every(interval, firstTask);
+  advance(interval - SCHEDULER_TICK);
+  TEST_ASSERT_EQUAL(0, firstRuns);
+  advance(SCHEDULER_TICK);
+  TEST_ASSERT_EQUAL(1, firstRuns);
+}
+
+void test_one_shot_task() {
+  int16_t id = TaskScheduler::once(50, firstTask);
+  advance(1000);
+  TEST_ASSERT_EQUAL(1, firstRuns);
+  TEST_ASSERT_NULL(TaskScheduler::getStats(id));
+}
+
+void test_cancel() {
+  int16_t first = TaskScheduler::every(100, firstTask);
+  TaskScheduler::every(100, secondTask);
+  advance(200);
+  TEST_ASSERT_TRUE(TaskScheduler::cancel(first));
+  advance(300);
+  TEST_ASSERT_EQUAL(2, firstRuns);
+  TEST_ASSERT_EQUAL(5, secondRuns);
+  TEST_ASSERT_FALSE(TaskScheduler::cancel(first));
+  TEST_ASSERT_FALSE(TaskScheduler::cancel(-1));
+  TEST_ASSERT_FALSE(TaskScheduler::cancel(MAX_SCHEDULED_TASKS));
+}
+
+// the slot of a finished one-shot task is reused, its old id must not cancel the new task
+void test_stale_id() {
+  int16_t stale = TaskScheduler::once(50, firstTask);
+  advance(100);
+  int16_t reused = TaskScheduler::every(100, secondTask);
+  TEST_ASSERT_EQUAL(stale & 0xFF, reused & 0xFF);
+  TEST_ASSERT_TRUE(stale != reused);
+  TEST_ASSERT_FALSE(TaskScheduler::cancel(stale));
+  TEST_ASSERT_NULL(TaskScheduler::getStats(stale));
+  advance(100);
+  TEST_ASSERT_EQUAL(1, secondRuns);
+  TEST_ASSERT_TRUE(TaskScheduler::cancel(reused));
+}
+
+// a blocked loop runs a late task once and skips the missed periods
+void test_late_runs_are_not_bursted() {
+  int16_t id = TaskScheduler::every(100, firstTask);
+  advance(100);
+  fakeMillis += 1000;
+  TaskScheduler::run();
+  TEST_ASSERT_EQUAL(2, firstRuns);
+  TEST_ASSERT_EQUAL(1, TaskScheduler::getStats(id)->lateRuns);
+  advance(100);
+  TEST_ASSERT_EQUAL(3, firstRuns);
+}
+
+void test_budget_overruns() {
+  int16_t id = TaskScheduler::every(100, slowTask, 500);
+  taskMicros = 200;
+  advance(100);
+  taskMicros = 800;
+  advance(100);
+  const TaskStats *stats = TaskScheduler::getStats(id);
+  TEST_ASSERT_EQUAL(2, stats->runs);
+  TEST_ASSERT_EQUAL(1, stats->overruns);
+  TEST_ASSERT_EQUAL(800, stats->maxMicros);
+  TEST_ASSERT_EQUAL(800, stats->lastMicros);
+  TEST_ASSERT_EQUAL(1000, stats->totalMicros);
+}
+
+void test_no_free_slots() {
+  for (int8_t i = 0; i < MAX_SCHEDULED_TASKS; i++) TEST_ASSERT_TRUE(TaskScheduler::every(100, firstTask) >= 0);
+  TEST_ASSERT_EQUAL(-1, TaskScheduler::every(100, secondTask));
+  TEST_ASSERT_EQUAL(-1, TaskScheduler::once(100, nullptr));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_periodic_task);
+  RUN_TEST(test_interval_longer_than_wheel);
+  RUN_TEST(test_one_shot_task);
+  RUN_TEST(test_cancel);
+  RUN_TEST(test_stale_id);
+  RUN_TEST(test_late_runs_are_not_bursted);
+  RUN_TEST(test_budget_overruns);
+  RUN_TEST(test_no_free_slots);
+  return UNITY_END();
+}
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+  delta_ota.py - Delta patches for OtaManager::updateFromUrl()
+
+  Copyright © 2020 - 2026  Davide Perini
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of
+  this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  You should have received a copy of the MIT License along with this program.
+  If not, see <https://opensource.org/licenses/MIT/>.
+
+  Usage: python3 delta_ota.py old_firmware.bin new_firmware.bin firmware.patch
+  old_firmware.bin must be the image running on the device, the patch is refused otherwise.
+"""
+
+import hashlib
+import struct
+import sys
+
+MAGIC = b"DOTA"
+KEY = 8  # bytes indexed in the old image
+MIN_MATCH = 24  # shorter matches are sent as extra bytes
+MAX_SCORE_DROP = 32  # mismatches tolerated while extending a match, code moved by a new release differs in addresses
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def index(old):
+    positions = {}
+    for pos in range(len(old) - KEY + 1):
+        positions.setdefault(old[pos:pos + KEY], pos)
+    return positions
+
+
+def extend(old, new, old_pos, new_pos):
+    """Length of the approximate match, bytes that differ are sent as diff bytes."""
+    score = best = best_length = 0
+    length = 0
+    limit = min(len(old) - old_pos, len(new) - new_pos)
+    while length < limit:
+        score += 1 if old[old_pos + length] == new[new_pos + length] else -1
+        length += 1
+        if score > best:
+            best, best_length = score, length
+        elif score < best - MAX_SCORE_DROP:
+            break
+    return best_length
+
+
+def matches(old, new):
+    """Approximate matches (old position, new position, length), in order of the new image."""
+    positions = index(old)
+    result = []
+    new_pos = 0
+    aligned = None  # old position that continues the last match
+    while new_pos < len(new):
+        candidates = []
+        if aligned is not None and aligned < len(old):
+            candidates.append(aligned)
+        found = positions.get(new[new_pos:new_pos + KEY])
+        if found is not None:
+            candidates.append(found)
+        best = (0, None)
+        for old_pos in candidates:
+            length = extend(old, new, old_pos, new_pos)
+            if length > best[0]:
+                best = (length, old_pos)
+        if best[0] >= MIN_MATCH:
+            result.append((best[1], new_pos, best[0]))
+            new_pos += best[0]
+            aligned = best[1] + best[0]
+        else:
+            new_pos += 1
+            if aligned is not None:
+                aligned += 1
+    return result
+
+
+def diff_runs(old, new, old_pos, new_pos, length):
+    """Diff bytes as runs of unchanged bytes and of changed bytes."""
+    diff = bytes((new[new_pos + i] - old[old_pos + i]) & 0xFF for i in range(length))
+    out = bytearray()
+    pos = 0
+    while pos < length:
+        same = pos
+        while same < length and diff[same] == 0:
+            same += 1
+        changed = same
+        while changed < length:
+            if diff[changed] != 0:
+                changed += 1
+                continue
+            zeros = changed
+            while zeros < length and diff[zeros] == 0:
+                zeros += 1
+            # short runs of unchanged bytes are cheaper inside the changed run
+            if zeros == length or zeros - changed >= 3:
+                break
+            changed = zeros
+        out += varint(same - pos) + varint(changed - same) + diff[same:changed]
+        pos = changed
+    return bytes(out)
+
+
+def make_patch(old, new):
+    patch = bytearray(MAGIC)
+    patch += struct.pack("<II", len(old), len(new))
+    patch += hashlib.md5(old).digest() + hashlib.md5(new).digest()
+    blocks = matches(old, new)
+    # the first block can start with extra bytes only
+    if not blocks or blocks[0][1] != 0:
+        blocks.insert(0, (0, 0, 0))
+    for i, (old_pos, new_pos, length) in enumerate(blocks):
+        next_new = blocks[i + 1][1] if i + 1 < len(blocks) else len(new)
+        extra = new[new_pos + length:next_new]
+        next_old = blocks[i + 1][0] if i + 1 < len(blocks) else old_pos + length
+        patch += varint(length) + varint(len(extra)) + varint(zigzag(next_old - (old_pos + length)))
+        patch += diff_runs(old, new, old_pos, new_pos, length)
+        patch += extra
+    return bytes(patch)
+
+
+def read_varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def apply_patch(old, patch):
+    """Same steps as the device, used to verify the patch before it is written."""
+    assert patch[:4] == MAGIC
+    old_size, new_size = struct.unpack_from("<II", patch, 4)
+    assert old_size == len(old) and patch[12:28] == hashlib.md5(old).digest()
+    pos = 44
+    old_pos = 0
+    new = bytearray()
+    while len(new) < new_size:
+        diff_length, pos = read_varint(patch, pos)
+        extra_length, pos = read_varint(patch, pos)
+        seek, pos = read_varint(patch, pos)
+        while diff_length > 0:
+            same, pos = read_varint(patch, pos)
+            changed, pos = read_varint(patch, pos)
+            assert 0 < same + changed <= diff_length
+            new += old[old_pos:old_pos + same]
+            old_pos += same
+            for i in range(changed):
+                new.append((old[old_pos + i] + patch[pos + i]) & 0xFF)
+            old_pos += changed
+            pos += changed
+            diff_length -= same + changed
+        new += patch[pos:pos + extra_length]
+        pos += extra_length
+        old_pos += (seek >> 1) ^ -(seek & 1)
+    assert hashlib.md5(new).digest() == patch[28:44]
+    return bytes(new)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(__doc__.strip().splitlines()[-2])
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as f:
+        old = f.read()
+    with open(sys.argv[2], "rb") as f:
+        new = f.read()
+    patch = make_patch(old, new)
+    assert apply_patch(old, patch) == new
+    with open(sys.argv[3], "wb") as f:
+        f.write(patch)
+    print("%s: %d bytes, %.1f%% of %d bytes" % (sys.argv[3], len(patch), 100.0 * len(patch) / len(new), len(new)))
+
+
+if __name__ == "__main__":
+    main()